@@ -0,0 +1,75 @@
+#ifndef __ARENA_HH__
+#define __ARENA_HH__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+/* bump allocator for objects that all die together (a region's
+ * blocks, instructions and phis), released in one shot with
+ * destructors run newest first */
+class arena {
+private:
+  static const size_t chunkSz = 1UL<<16;
+  struct dtor {
+    void (*f)(void*);
+    void *p;
+  };
+  std::vector<uint8_t*> chunks;
+  std::vector<dtor> dtors;
+  uint8_t *cur = nullptr, *end = nullptr;
+  size_t allocated = 0;
+  void *alloc(size_t sz, size_t align) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(align-1);
+    if(cur == nullptr or (p + sz) > reinterpret_cast<uintptr_t>(end)) {
+      size_t len = (sz + align) > chunkSz ? (sz + align) : chunkSz;
+      uint8_t *c = reinterpret_cast<uint8_t*>(std::malloc(len));
+      if(c == nullptr) {
+	throw std::bad_alloc();
+      }
+      chunks.push_back(c);
+      cur = c;
+      end = c + len;
+      p = (reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(align-1);
+    }
+    cur = reinterpret_cast<uint8_t*>(p + sz);
+    allocated += sz;
+    return reinterpret_cast<void*>(p);
+  }
+public:
+  arena() {}
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+  ~arena() {
+    release();
+  }
+  template <typename T, typename... Args>
+  T *make(Args&&... args) {
+    T *o = new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if(not(std::is_trivially_destructible<T>::value)) {
+      dtors.push_back(dtor{[](void *p) { reinterpret_cast<T*>(p)->~T(); }, o});
+    }
+    return o;
+  }
+  void release() {
+    for(auto it = dtors.rbegin(); it != dtors.rend(); ++it) {
+      it->f(it->p);
+    }
+    dtors.clear();
+    for(uint8_t *c : chunks) {
+      std::free(c);
+    }
+    chunks.clear();
+    cur = end = nullptr;
+    allocated = 0;
+  }
+  size_t bytes() const {
+    return allocated;
+  }
+};
+
+#endif
@@ -10,8 +10,11 @@
 #include <cstdlib>
 #include <cstdio>
 #include <functional>
+#include <fstream>
+#include <sstream>
 
 #include "globals.hh"
+#include "guestMem.hh"
 #include "simPoints.hh"
 
 uint64_t basicBlock::cfgCnt = 0;
@@ -70,6 +73,7 @@ void basicBlock::repairBrokenEdges() {
 	if(nbb->getEntryAddr() != nextpc) {
 	  auto it0 = succs.find(nbb);
 	  succs.erase(it0);
+	  succCache.fill(nullptr);
 	  auto it1 = nbb->preds.find(this);
 	  if(it1 != nbb->preds.end()) {
 	    nbb->preds.erase(it1);
@@ -85,9 +89,9 @@ void basicBlock::repairBrokenEdges() {
 
 void basicBlock::dropAllBBs() {
   cfgCnt = 0;
-  for(auto &p : bbMap) {
-    delete p.second;
-  }
+  bbMap.forEach([](uint32_t pc, basicBlock *bb) {
+      delete bb;
+    });
   bbMap.clear();
   insMap.clear();
   insInBBCnt.clear();
@@ -95,6 +99,400 @@ void basicBlock::dropAllBBs() {
   globals::regionFinder->disableRegionCollection();
 }
 
+void basicBlock::saveProfile(const std::string &fname) {
+  std::ofstream out(fname);
+  if(not(out.is_open())) {
+    std::cerr << globals::binaryName << ": unable to write profile " << fname << "\n";
+    return;
+  }
+  out << std::hex << "profile " << globals::elfHash << "\n";
+  bbMap.forEach([&out](uint32_t pc, basicBlock *bb) {
+      if(not(bb->readOnly)) {
+	return;
+      }
+      out << "b " << pc << " " << bb->termAddr << " "
+	  << bb->branchLikely << " " << bb->vecIns.size();
+      for(const auto &p : bb->vecIns) {
+	out << " " << p.first << " " << p.second;
+      }
+      out << "\n";
+    });
+  bbMap.forEach([&out](uint32_t pc, basicBlock *bb) {
+      if(not(bb->readOnly)) {
+	return;
+      }
+      out << "e " << pc << " " << bb->totalEdges << " " << bb->edgeCnts.size();
+      for(const auto &e : bb->edgeCnts) {
+	out << " " << e.first << " " << e.second;
+      }
+      out << " " << bb->succs.size();
+      for(basicBlock *sbb : bb->succs) {
+	out << " " << sbb->entryAddr;
+      }
+      out << "\n";
+    });
+  bbMap.forEach([&out](uint32_t pc, basicBlock *bb) {
+      if(bb->cfgCplr == nullptr) {
+	return;
+      }
+      out << (bb->cfgCplr->isFunction() ? "f " : "r ") << pc << " " << bb->cfgCplr->blocks.size();
+      for(basicBlock *rbb : bb->cfgCplr->blocks) {
+	out << " " << rbb->entryAddr;
+      }
+      out << "\n";
+    });
+}
+
+static uint32_t fetchInsn(const uint8_t *mem, uint32_t pc);
+
+bool basicBlock::loadProfile(const std::string &fname) {
+  std::ifstream in(fname);
+  std::string line, tag;
+  uint32_t hash = 0;
+  if(not(in.is_open()) or not(in >> tag >> std::hex >> hash) or (tag != "profile")) {
+    std::cerr << globals::binaryName << ": unable to read profile " << fname << "\n";
+    return false;
+  }
+  if(hash != globals::elfHash) {
+    std::cerr << globals::binaryName << ": profile " << fname
+	      << " was recorded with a different binary\n";
+    return false;
+  }
+  std::vector<std::string> lines;
+  while(std::getline(in, line)) {
+    lines.push_back(line);
+  }
+  /* blocks are built from the recorded words, so every
+   * one of them has to match guest memory */
+  for(const std::string &l : lines) {
+    std::istringstream ss(l);
+    ss >> std::hex;
+    uint32_t pc = 0, termAddr = 0;
+    bool likely = false;
+    size_t n = 0;
+    if(not(ss >> tag >> pc) or (tag != "b")) {
+      continue;
+    }
+    ss >> termAddr >> likely >> n;
+    for(size_t i = 0; i < n; i++) {
+      uint32_t inst = 0, addr = 0;
+      if(not(ss >> inst >> addr) or (fetchInsn(regionCFG::guestMem, addr) != inst)) {
+	std::cerr << globals::binaryName << ": profile " << fname
+		  << " doesn't match guest memory at 0x" << std::hex << addr << std::dec << "\n";
+	return false;
+      }
+    }
+  }
+  std::vector<std::vector<basicBlock*>> regions;
+  std::set<basicBlock*> funcHeads;
+  for(const std::string &l : lines) {
+    std::istringstream ss(l);
+    ss >> std::hex;
+    uint32_t pc = 0;
+    size_t n = 0;
+    if(not(ss >> tag >> pc)) {
+      continue;
+    }
+    if(tag == "b") {
+      basicBlock *bb = new basicBlock(pc);
+      ss >> bb->termAddr >> bb->branchLikely >> n;
+      for(size_t i = 0; i < n; i++) {
+	uint32_t inst = 0, addr = 0;
+	ss >> inst >> addr;
+	bb->addIns(inst, addr);
+      }
+      bb->setReadOnly();
+      continue;
+    }
+    basicBlock *bb = bbMap.get(pc);
+    if(bb == nullptr) {
+      continue;
+    }
+    if(tag == "e") {
+      ss >> bb->totalEdges >> n;
+      for(size_t i = 0; i < n; i++) {
+	uint32_t epc = 0;
+	ss >> epc;
+	ss >> bb->edgeCnts[epc];
+      }
+      ss >> n;
+      for(size_t i = 0; i < n; i++) {
+	uint32_t spc = 0;
+	ss >> spc;
+	basicBlock *sbb = bbMap.get(spc);
+	if(sbb) {
+	  bb->addSuccessor(sbb);
+	}
+      }
+    }
+    else if((tag == "r") or (tag == "f")) {
+      std::vector<basicBlock*> region = {bb};
+      if(tag == "f") {
+	funcHeads.insert(bb);
+      }
+      ss >> n;
+      for(size_t i = 0; i < n; i++) {
+	uint32_t rpc = 0;
+	ss >> rpc;
+	basicBlock *rbb = bbMap.get(rpc);
+	if(rbb and (rbb != bb)) {
+	  region.push_back(rbb);
+	}
+      }
+      regions.push_back(region);
+    }
+  }
+  /* the graph is complete, queue every region for codegen */
+  for(const auto &region : regions) {
+    basicBlock *head = region.at(0);
+    std::vector<std::vector<basicBlock*>> rr = {region};
+    if(funcHeads.find(head) == funcHeads.end()) {
+      head->cfgCplr = new regionCFG();
+    }
+    else if(globals::chainRegions) {
+      head->cfgCplr = new funcCFG();
+    }
+    else {
+      /* host calls need linked exits */
+      continue;
+    }
+    if(head->cfgCplr->buildCFG(rr)) {
+      head->hasRegion = not(head->cfgCplr->compilePending());
+      for(basicBlock *rbb : region) {
+	rbb->cfgInRegions.insert(head);
+      }
+    }
+    else {
+      delete head->cfgCplr;
+      head->cfgCplr = nullptr;
+    }
+  }
+  return true;
+}
+
+static uint32_t fetchInsn(const uint8_t *mem, uint32_t pc) {
+  if(globals::isMipsEL) {
+    return loadGuest<true,false,uint32_t>(mem, pc);
+  }
+  return globals::hostEndianMem ? loadGuest<false,true,uint32_t>(mem, pc) :
+    loadGuest<false,false,uint32_t>(mem, pc);
+}
+
+static bool isLikelyBranch(uint32_t inst) {
+  uint32_t opcode = inst>>26, rt = (inst>>16) & 31;
+  switch(opcode)
+    {
+    case 0x01:
+      return (rt == 2) or (rt == 3);
+    case 0x11:
+      return (((inst>>21) & 31) == 0x8) and ((inst>>17) & 1);
+    case 0x14:
+    case 0x15:
+    case 0x16:
+    case 0x17:
+      return true;
+    default:
+      break;
+    }
+  return false;
+}
+
+/* b (beq $0,$0) and bal (bgez $0) never fall through */
+static bool isAlwaysTaken(uint32_t inst) {
+  return ((inst>>16) == 0x1000) or ((inst>>16) == 0x0401);
+}
+
+/* control flow leaving the instruction at pc that
+ * stays within [lo,hi) */
+static void staticTargets(uint32_t inst, uint32_t pc, uint32_t lo, uint32_t hi,
+			  std::vector<uint32_t> &targets) {
+  auto inRange = [lo,hi](uint32_t a) { return (a >= lo) and (a < hi); };
+  uint32_t target = ~0U;
+  if(is_branch(inst)) {
+    target = get_branch_target(pc, inst);
+    if(not(isAlwaysTaken(inst)) and inRange(pc+8)) {
+      targets.push_back(pc+8);
+    }
+  }
+  else if(is_j(inst)) {
+    target = get_jump_target(pc, inst);
+  }
+  else if((is_jal(inst) or is_jalr(inst)) and inRange(pc+8)) {
+    /* landing pad of the return */
+    targets.push_back(pc+8);
+  }
+  if(inRange(target)) {
+    targets.push_back(target);
+  }
+}
+
+bool basicBlock::discoverFunction(uint32_t entry, uint32_t len, const uint8_t *mem,
+				  std::vector<basicBlock*> &blocks) {
+  const uint32_t hi = entry + len;
+  std::set<uint32_t> leaders, delaySlots;
+  std::vector<uint32_t> work = {entry};
+  /* split points tracing would eventually find */
+  while(not(work.empty())) {
+    uint32_t pc = work.back();
+    work.pop_back();
+    if(not(leaders.insert(pc).second)) {
+      continue;
+    }
+    for(uint32_t a = pc; ; a += 4) {
+      if(((a + 4) >= hi) or insMap.get(a)) {
+	return false;
+      }
+      uint32_t inst = fetchInsn(mem, a);
+      if(is_monitor(inst)) {
+	return false;
+      }
+      if(isBranchOrJump(inst)) {
+	delaySlots.insert(a+4);
+	staticTargets(inst, a, entry, hi, work);
+	break;
+      }
+    }
+  }
+  for(uint32_t pc : leaders) {
+    if(delaySlots.find(pc) != delaySlots.end()) {
+      return false;
+    }
+  }
+  for(uint32_t pc : leaders) {
+    basicBlock *bb = new basicBlock(pc);
+    for(uint32_t a = pc; ; a += 4) {
+      uint32_t inst = fetchInsn(mem, a);
+      bb->addIns(inst, a);
+      if(isBranchOrJump(inst)) {
+	bb->addIns(fetchInsn(mem, a+4), a+4);
+	bb->termAddr = a;
+	bb->branchLikely = isLikelyBranch(inst);
+	break;
+      }
+      if(leaders.find(a+4) != leaders.end()) {
+	bb->termAddr = a;
+	break;
+      }
+    }
+    bb->setReadOnly();
+    blocks.push_back(bb);
+  }
+  for(basicBlock *bb : blocks) {
+    std::vector<uint32_t> targets;
+    uint32_t inst = fetchInsn(mem, bb->termAddr);
+    if(isBranchOrJump(inst)) {
+      if(not(is_jal(inst) or is_jalr(inst))) {
+	staticTargets(inst, bb->termAddr, entry, hi, targets);
+      }
+    }
+    else {
+      targets.push_back(bb->termAddr + 4);
+    }
+    for(uint32_t t : targets) {
+      bb->addSuccessor(bbMap.get(t));
+    }
+  }
+  return true;
+}
+
+void basicBlock::translateStatic(const std::map<uint32_t, std::pair<std::string, uint32_t>> &syms,
+				 const uint8_t *mem) {
+  std::vector<basicBlock*> blocks;
+  std::vector<basicBlock*> funcs;
+  for(const auto &p : syms) {
+    if(discoverFunction(p.first, p.second.second, mem, blocks)) {
+      funcs.push_back(bbMap.get(p.first));
+    }
+  }
+  /* calls go to the callee entry, like a trace would record */
+  for(basicBlock *bb : blocks) {
+    uint32_t inst = fetchInsn(mem, bb->termAddr);
+    if(is_jal(inst)) {
+      basicBlock *callee = bbMap.get(get_jump_target(bb->termAddr, inst));
+      if(callee) {
+	bb->addSuccessor(callee);
+      }
+    }
+  }
+  std::set<uint32_t> leafs;
+  for(basicBlock *entryBB : funcs) {
+    std::vector<basicBlock*> func;
+    int numErrors = 0;
+    if(findLeafNodeFunc(entryBB, syms, func, numErrors) == funcComplStatus::success) {
+      leafs.insert(entryBB->entryAddr);
+    }
+  }
+  /* returns from an inlined leaf land after each of its call sites */
+  for(basicBlock *bb : blocks) {
+    uint32_t inst = fetchInsn(mem, bb->termAddr);
+    if(not(is_jal(inst)) or (bb->succs.size() != 1)) {
+      continue;
+    }
+    basicBlock *callee = *(bb->succs.begin());
+    basicBlock *landing = bbMap.get(bb->termAddr + 8);
+    if((leafs.find(callee->entryAddr) == leafs.end()) or (landing == nullptr)) {
+      continue;
+    }
+    std::vector<basicBlock*> leaf;
+    int numErrors = 0;
+    findLeafNodeFunc(callee, syms, leaf, numErrors);
+    for(basicBlock *lbb : leaf) {
+      if(lbb->hasJR(true)) {
+	lbb->addSuccessor(landing);
+      }
+    }
+  }
+  size_t nRegions = 0;
+  for(basicBlock *entryBB : funcs) {
+    std::vector<basicBlock*> func;
+    funcComplStatus rc = findFuncWithInline(entryBB, syms, leafs, func, globals::chainRegions);
+    if(rc != funcComplStatus::success) {
+      continue;
+    }
+    std::set<basicBlock*> seen;
+    std::vector<basicBlock*> region;
+    for(basicBlock *bb : func) {
+      if(seen.insert(bb).second) {
+	region.push_back(bb);
+      }
+    }
+    /* compiled j's must stay inside the region (no tail calls) */
+    bool closed = true;
+    for(basicBlock *bb : region) {
+      uint32_t inst = fetchInsn(mem, bb->termAddr);
+      if(is_j(inst)) {
+	basicBlock *tbb = bbMap.get(get_jump_target(bb->termAddr, inst));
+	closed &= (seen.find(tbb) != seen.end());
+      }
+    }
+    if(not(closed)) {
+      continue;
+    }
+    std::vector<std::vector<basicBlock*>> rr = {region};
+    if(globals::chainRegions) {
+      entryBB->cfgCplr = new funcCFG();
+    }
+    else {
+      entryBB->cfgCplr = new regionCFG();
+    }
+    if(entryBB->cfgCplr->buildCFG(rr)) {
+      entryBB->hasRegion = not(entryBB->cfgCplr->compilePending());
+      for(basicBlock *rbb : region) {
+	rbb->cfgInRegions.insert(entryBB);
+      }
+      nRegions++;
+    }
+    else {
+      delete entryBB->cfgCplr;
+      entryBB->cfgCplr = nullptr;
+    }
+  }
+  if(globals::verbose) {
+    std::cerr << globals::binaryName << ": " << funcs.size() << " of " << syms.size()
+	      << " functions discovered statically, " << nRegions << " translated\n";
+  }
+}
+
 void basicBlock::setReadOnly() {
   if(not(readOnly)) {
     readOnly = true;
@@ -111,10 +509,22 @@ void basicBlock::setReadOnly() {
       }
       hasmonitor |= is_monitor(insn);
     }
+    pdIns.resize(vecIns.size());
+    for(size_t i = 0, len = vecIns.size(); i < len; i++) {
+      if(not(predecode(vecIns[i].first, vecIns[i].second, (i+1) < len, pdIns[i]))) {
+	pdIns.clear();
+	break;
+      }
+    }
     if(cfgCplr) {
+      regionCFG::discard(cfgCplr);
       cfgCplr=nullptr;
-      delete cfgCplr;
     }
+    if(blockCplr) {
+      delete blockCplr;
+      blockCplr=nullptr;
+    }
+    blockRuns = 0;
     hasRegion = isCompiled = false;
     bbRegions.clear();
     bbRegionCounts.clear();
@@ -125,7 +535,7 @@ void basicBlock::setReadOnly() {
 
 void basicBlock::addSuccessor(basicBlock *bb) {
   succs.insert(bb);
-  succsMap[bb->entryAddr] = bb;
+  succCache[succCacheIdx(bb->entryAddr)] = bb;
   bb->preds.insert(this);
 
   
@@ -143,7 +553,7 @@ void basicBlock::addSuccessor(basicBlock *bb) {
 }
 
 basicBlock::basicBlock(uint32_t entryAddr) : execUnit(), entryAddr(entryAddr) {
-  bbMap[entryAddr] = this;  
+  bbMap.set(entryAddr, this);
 }
 
 basicBlock::basicBlock(uint32_t entryAddr, basicBlock *prev) : basicBlock(entryAddr) {
@@ -160,8 +570,8 @@ void basicBlock::addIns(uint32_t inst, uint32_t addr) {
       die();
     }
 #endif
-    insMap[addr] = this;
-    insInBBCnt[addr]++;
+    insMap.set(addr, this);
+    insInBBCnt.set(addr, insInBBCnt.get(addr) + 1);
     
     //if(insInBBCnt[addr] > 1) {
     //std::cerr << *this;
@@ -175,7 +585,7 @@ void basicBlock::dropCompiledCode() {
   bbRegionCounts.clear();
   for(basicBlock *nukeBB : cfgInRegions){
     if(nukeBB->cfgCplr) {
-      delete nukeBB->cfgCplr;
+      regionCFG::discard(nukeBB->cfgCplr);
       nukeBB->cfgCplr = nullptr;
       nukeBB->hasRegion = false;
     }
@@ -209,22 +619,22 @@ basicBlock *basicBlock::split(uint32_t nEntryAddr) {
   for(basicBlock *b : succs) {
     auto ssit = b->preds.find(this);
     b->preds.erase(ssit);
-    nBB->succsMap[b->entryAddr] = b;
+    nBB->succCache[succCacheIdx(b->entryAddr)] = b;
     nBB->succs.insert(b);
     b->preds.insert(nBB);
   }
   //add new successor
   succs.clear();
-  succsMap.clear();
+  succCache.fill(nullptr);
 
-  succsMap[nBB->entryAddr] = nBB;
+  succCache[succCacheIdx(nBB->entryAddr)] = nBB;
   succs.insert(nBB);
   nBB->preds.insert(this);
   
   for(size_t i = offs, len = vecIns.size(); i < len; i++) {
     uint32_t addr = i*4 + entryAddr;
-    insMap[addr] = nBB;
-    insInBBCnt[addr]++;
+    insMap.set(addr, nBB);
+    insInBBCnt.set(addr, insInBBCnt.get(addr) + 1);
     nBB->vecIns.push_back(vecIns[i]);
   }
   
@@ -254,46 +664,40 @@ basicBlock *basicBlock::split(uint32_t nEntryAddr) {
 }
 
 basicBlock *basicBlock::globalFindBlock(uint32_t entryAddr) {
-  auto it = bbMap.find(entryAddr);
-  if(it == bbMap.end())
-    return nullptr;
-  else
-    return it->second;
+  return bbMap.get(entryAddr);
 }
 
 basicBlock *basicBlock::localFindBlock(uint32_t entryAddr) {
   if(entryAddr == this->entryAddr)
     return this;
 
-  const auto it = succsMap.find(entryAddr);
-  if(it == succsMap.end())
-    return nullptr;
-  else
-    return it->second;
+  basicBlock *cBB = succCache[succCacheIdx(entryAddr)];
+  if(cBB and (cBB->entryAddr == entryAddr)) {
+    return cBB;
+  }
+  for(basicBlock *nbb : succs) {
+    if(nbb->entryAddr == entryAddr) {
+      return nbb;
+    }
+  }
+  return nullptr;
 }
 
 basicBlock *basicBlock::findBlock(uint32_t entryAddr) {
-  basicBlock *fBlock = nullptr;
-  auto sIt = succsMap.find(entryAddr);
-  
-  if(sIt != succsMap.end()) {
-    fBlock = sIt->second;
+  basicBlock *fBlock = succCache[succCacheIdx(entryAddr)];
+  if(fBlock and (fBlock->entryAddr == entryAddr)) {
+    return fBlock;
+  }
+  fBlock = bbMap.get(entryAddr);
+  if(fBlock) {
+    addSuccessor(fBlock);
   }
   else {
-    auto bIt =  bbMap.find(entryAddr);
-    if(bIt != bbMap.end()) {
-      fBlock = bIt->second;
+    basicBlock *sBB = insMap.get(entryAddr);
+    if(sBB) {
+      fBlock = sBB->split(entryAddr);
       addSuccessor(fBlock);
     }
-    else {
-      auto iIt = insMap.find(entryAddr);
-      if(iIt != insMap.end()) {
-	basicBlock *sBB = iIt->second;
-	basicBlock *nBB = sBB->split(entryAddr);
-	fBlock = nBB;
-	addSuccessor(fBlock);
-      }
-    }
   }
   return fBlock;
 }
@@ -350,11 +754,19 @@ basicBlock* basicBlock::run(state_t *s) {
   if(globals::simPoints) {
     log_bb(s->pc, s->icnt);
   }
-  if(globals::isMipsEL) {
+  if(static_cast<size_t>(length) < pdIns.size()) {
+    interpretPredecoded(pdIns.data(), length+1, s);
+  }
+  else if(globals::isMipsEL) {
     for(ssize_t i = 0; (i <= length) && (s->brk == 0); i++) { 
       interpretEL(s);
     }
   }
+  else if(globals::hostEndianMem) {
+    for(ssize_t i = 0; (i <= length) && (s->brk == 0); i++) { 
+      interpretHE(s);
+    }
+  }
   else {
     for(ssize_t i = 0; (i <= length) && (s->brk == 0); i++) { 
       interpret(s);
@@ -419,6 +831,8 @@ bool basicBlock::executeJIT(state_t *s) {
     return false;
   }
   
+  regionCFG::installCompiled();
+  
   if(/*not(globals::replay) and*/ globals::regionFinder->update(this)) {
     globals::regionFinder->getRegion(bbRegion);
     gotRegion = true;    
@@ -436,7 +850,8 @@ bool basicBlock::executeJIT(state_t *s) {
   if(gotRegion) {
     bool canCompile = canCompileRegion(bbRegion);
     addRegion(bbRegion);
-    if(enoughRegions() and canCompile) {
+    /* cfgCplr may still be in the compile queue */
+    if(enoughRegions() and canCompile and (cfgCplr == nullptr)) {
       if(globals::enableCFG) {
 	cfgCplr = new regionCFG();
 	double now = timestamp();
@@ -464,7 +879,8 @@ bool basicBlock::executeJIT(state_t *s) {
 #endif
 	  bbRegions.clear();
 	  bbRegionCounts.clear();
-	  hasRegion = true;
+	  /* otherwise set by regionCFG::installCompiled() */
+	  hasRegion = not(cfgCplr->compilePending());
 	}
 	else {
 	  delete cfgCplr;
@@ -482,12 +898,21 @@ bool basicBlock::executeJIT(state_t *s) {
   }
   
   s->oldpc = s->pc;
+
+  if(globals::blockJitThresh and not(isCompiled or hasRegion)) {
+    if(++blockRuns == globals::blockJitThresh) {
+      compileBlock();
+    }
+  }
   
   if(hasRegion and not(globals::regionFinder->collectionEnabled())) {
     if(cfgCplr)  {
       nBB = cfgCplr->run(s);
     }
   }
+  else if(isCompiled and not(globals::regionFinder->collectionEnabled())) {
+    nBB = runCompiled(s);
+  }
   else {
     nBB = this->run(s);
   }
@@ -504,9 +929,46 @@ bool basicBlock::executeJIT(state_t *s) {
 }
 
 
+void basicBlock::compileBlock() {
+  std::vector<basicBlock*> blk = {this};
+  if(not(canCompileRegion(blk))) {
+    return;
+  }
+  /* a lone block can only jump to itself */
+  for(const auto &p : vecIns) {
+    if((is_j(p.first) or is_jal(p.first)) and
+       (get_jump_target(p.second, p.first) != entryAddr)) {
+      return;
+    }
+  }
+  std::vector<std::vector<basicBlock*>> regions = {blk};
+  blockCplr = new regionCFG(true);
+  if(blockCplr->buildCFG(regions)) {
+    isCompiled = true;
+  }
+  else {
+    delete blockCplr;
+    blockCplr = nullptr;
+  }
+}
+
+basicBlock* basicBlock::runCompiled(state_t *s) {
+  uint64_t i0 = s->icnt;
+  blockCplr->run(s);
+  inscnt += s->icnt - i0;
+  /* compiled code points cBB at the exiting block,
+   * which differs from this one after a chained exit */
+  basicBlock *lBB = globals::cBB;
+  lBB->edgeCnts[s->pc]++;
+  lBB->totalEdges++;
+  return lBB->findBlock(s->pc);
+}
+
 basicBlock::~basicBlock() {
   if(cfgCplr)
-    delete cfgCplr;
+    regionCFG::discard(cfgCplr);
+  if(blockCplr)
+    delete blockCplr;
 }
 
 void basicBlock::info() {
@@ -599,6 +1061,11 @@ funcComplStatus findLeafNodeFunc(basicBlock* entryBB,
       numErrors++;
       return;
     }
+    else if(bb->hasJAL() and bb->getSuccs().empty()) {
+      /* callee never discovered */
+      rc = funcComplStatus::direct_call;
+      numErrors++;
+    }
     else if(bb->hasJAL()) {
       auto s = *(bb->getSuccs().begin());
       uint32_t spc = s->getEntryAddr();
@@ -648,11 +1115,23 @@ funcComplStatus findLeafNodeFunc(basicBlock* entryBB,
 funcComplStatus findFuncWithInline(basicBlock* entryBB,
 				   const std::map<uint32_t, std::pair<std::string, uint32_t>> &syms,
 				   const std::set<uint32_t> & leaf_funcs,
-				   std::vector<basicBlock*> &func) {
+				   std::vector<basicBlock*> &func,
+				   bool nativeCalls) {
   funcComplStatus rc = funcComplStatus::success;
   std::set<basicBlock*> seen;
   int numErrors = 0;
   
+  /* with host calls a function must stay within its symbol */
+  uint32_t funcBegin = 0, funcEnd = ~0U;
+  auto sit = syms.find(entryBB->getEntryAddr());
+  if(nativeCalls and (sit != syms.end())) {
+    funcBegin = sit->first;
+    funcEnd = funcBegin + sit->second.second;
+  }
+  auto inFunc = [&](basicBlock *bb) {
+    return (bb->getEntryAddr() >= funcBegin) and (bb->getEntryAddr() < funcEnd);
+  };
+  
   std::function<void(basicBlock*)> searcher = [&](basicBlock *bb) {
     bool gotJal = false;
     if(seen.find(bb)!=seen.end())
@@ -660,11 +1139,28 @@ funcComplStatus findFuncWithInline(basicBlock* entryBB,
 
     seen.insert(bb);
 
+    if(not(inFunc(bb))) {
+      /* tail call */
+      rc = funcComplStatus::direct_call;
+      numErrors++;
+      return;
+    }
+
     if(bb->hasJALR()) {
       rc = funcComplStatus::indirect_call;
       numErrors++;
       return;
     }
+    else if(bb->hasJAL() and bb->getSuccs().empty()) {
+      if(nativeCalls) {
+	gotJal = true;
+      }
+      else {
+	rc = funcComplStatus::direct_call;
+	numErrors++;
+	return;
+      }
+    }
     else if(bb->hasJAL()) {
       auto s = *(bb->getSuccs().begin());
       uint32_t spc = s->getEntryAddr();
@@ -674,6 +1170,10 @@ funcComplStatus findFuncWithInline(basicBlock* entryBB,
 	assert(s==funcComplStatus::success);
 	gotJal = true;
       }
+      else if(nativeCalls and (inlineBB != entryBB)) {
+	/* not inlined, the call returns to the landing pad */
+	gotJal = true;
+      }
       else {
 	rc = funcComplStatus::direct_call;
 	numErrors++;
@@ -699,7 +1199,7 @@ funcComplStatus findFuncWithInline(basicBlock* entryBB,
 	searcher(nbb);
       }
     }
-    else {
+    else if(gotJal) {
       uint32_t jaddr = ~0U;
       for(auto &p : bb->getVecIns())  {
 	if(is_jal(p.first)) {
@@ -709,12 +1209,16 @@ funcComplStatus findFuncWithInline(basicBlock* entryBB,
       }
       basicBlock *nbb = basicBlock::globalFindBlock(jaddr+8);
       if(nbb == nullptr) {
-	std::cout << "CANT FIND LANDING PAD\n";
+	if(globals::verbose) {
+	  std::cerr << "CANT FIND LANDING PAD\n";
+	}
 	rc = funcComplStatus::arbitrary_jr;
 	return;
       }
-	
-      searcher(nbb);
+      /* past the end of the function, the callee doesn't return */
+      if(inFunc(nbb)) {
+	searcher(nbb);
+      }
     }
     func.push_back(bb);
   };
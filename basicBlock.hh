@@ -10,9 +10,13 @@
 #include <cstdlib>
 #include <ostream>
 #include <map>
+#include <array>
 
 #include "mips.hh"
 #include "execUnit.hh"
+#include "interpret.hh"
+#include "pcTable.hh"
+#include "smallSet.hh"
 
 class compile;
 class regionCFG;
@@ -35,30 +39,53 @@ private:
       return a->getEntryAddr() < b->getEntryAddr();
     }
   };
+  /* almost every mips block has one or two successors */
+  typedef smallSet<basicBlock*, 2, orderBasicBlocks> blockSet;
   static uint64_t cfgCnt;
-  static std::map<uint32_t, basicBlock*> bbMap;
-  static std::map<uint32_t, basicBlock*> insMap;
-  static std::map<uint32_t, uint64_t> insInBBCnt;
+  static pcTable<basicBlock*> bbMap;
+  static pcTable<basicBlock*> insMap;
+  static pcTable<uint64_t> insInBBCnt;
   uint32_t entryAddr=0;  
-  std::set<basicBlock*, orderBasicBlocks> preds,succs;
-  std::map<uint32_t, basicBlock *> succsMap;
+  blockSet preds,succs;
+  /* direct mapped cache of successors, in front of succs */
+  std::array<basicBlock*, 2> succCache = {{nullptr, nullptr}};
+  static size_t succCacheIdx(uint32_t pc) {
+    return (pc >> 2) & 1;
+  }
   bool isCompiled = false, hasRegion = false;
-  std::map<uint32_t, uint32_t> bbRegionCounts; 
+  smallMap<uint32_t, uint32_t, 2> bbRegionCounts;
   std::vector <std::vector<basicBlock*>>bbRegions;
   bool hasTermBranchOrJump = false;
   regionCFG *cfgCplr = nullptr;
+  /* baseline tier code for this block alone */
+  regionCFG *blockCplr = nullptr;
+  uint64_t blockRuns = 0;
   uint32_t termAddr=0;
   bool readOnly=false, branchLikely=false;
   bool hasjr=false, hasjal=false, hasjalr = false, hasmonitor=false;
   uint64_t totalEdges = 0;
   insContainer vecIns;
-  std::map<uint32_t, uint64_t> edgeCnts;
+  /* decoded copy of vecIns, built by setReadOnly() */
+  std::vector<predecodedInsn> pdIns;
+  smallMap<uint32_t, uint64_t, 2> edgeCnts;
   static bool canCompileRegion(std::vector<basicBlock*> &region);
+  void compileBlock();
+  basicBlock *runCompiled(state_t *s);
   /* heads of regions that include this block */
   std::set<basicBlock*> cfgInRegions;
   void toposort(const std::set<basicBlock*> &valid, std::list<basicBlock*> &ordered, std::set<basicBlock*> &visited);
 public:
   static void dropAllBBs();
+  /* block graph, edge counts and compiled regions, so a
+   * later run of the same binary can skip warm-up */
+  static void saveProfile(const std::string &fname);
+  static bool loadProfile(const std::string &fname);
+  /* ahead of time : blocks from the symbol table, one region per
+   * leaf function or function that only calls leaves */
+  static void translateStatic(const std::map<uint32_t, std::pair<std::string, uint32_t>> &syms,
+			      const uint8_t *mem);
+  static bool discoverFunction(uint32_t entry, uint32_t len, const uint8_t *mem,
+			       std::vector<basicBlock*> &blocks);
   void report(std::string &s, uint64_t icnt) override;
   void info() override;
   basicBlock* run(state_t *s) override;
@@ -152,9 +179,12 @@ public:
   bool hasMONITOR() const {
     return hasmonitor;
   }
-  const std::set<basicBlock*, orderBasicBlocks> &getSuccs() const {
+  const blockSet &getSuccs() const {
     return succs;
   }
+  const blockSet &getPreds() const {
+    return preds;
+  }
   void addToCFGRegions(basicBlock *bb) {
     cfgInRegions.insert(bb);
   }
@@ -201,7 +231,8 @@ funcComplStatus findLeafNodeFunc(basicBlock* entryBB,
 funcComplStatus findFuncWithInline(basicBlock* entryBB,
 				   const std::map<uint32_t, std::pair<std::string, uint32_t>> &syms,
 				   const std::set<uint32_t> & leaf_funcs,
-				   std::vector<basicBlock*> &func);
+				   std::vector<basicBlock*> &func,
+				   bool nativeCalls = false);
 
 
 
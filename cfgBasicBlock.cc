@@ -5,13 +5,6 @@
 #include "helper.hh"
 #include "globals.hh"
 
-cfgBasicBlock::~cfgBasicBlock() {
-  for(size_t i = 0; i < insns.size(); i++) 
-    delete insns[i];
-  for(size_t i = 0; i < phiNodes.size(); i++) 
-    delete phiNodes[i];
-}
-
 void cfgBasicBlock::addWithInCFGEdges(regionCFG *cfg) {
   /* if this block has a branch, search if successor
    * is in CFG region */
@@ -19,7 +12,7 @@ void cfgBasicBlock::addWithInCFGEdges(regionCFG *cfg) {
   jTypeInsn *jJump = nullptr;
   rTypeInsn *jrInsn = nullptr;
   fpBranchInsn *fBranch = nullptr;
-  std::map<uint32_t,cfgBasicBlock*>::iterator mit0,mit1;
+  cfgBasicBlock *mit0 = nullptr, *mit1 = nullptr;
   uint32_t tAddr=~0,ntAddr=~0;
 
   /* this is crappy code */
@@ -42,47 +35,47 @@ void cfgBasicBlock::addWithInCFGEdges(regionCFG *cfg) {
   if(iBranch) {
     tAddr = iBranch->getTakenAddr();
     ntAddr = iBranch->getNotTakenAddr();
-    mit0 = cfg->cfgBlockMap.find(tAddr);
-    mit1 = cfg->cfgBlockMap.find(ntAddr);
-    if(mit0 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit0->second);
-      addSuccessor(mit0->second); 
+    mit0 = cfg->findBlock(tAddr);
+    mit1 = cfg->findBlock(ntAddr);
+    if(mit0) {
+      //PRINT_ADDED_EDGE(mit0);
+      addSuccessor(mit0); 
     }
-    if(mit1 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit1->second);
-      addSuccessor(mit1->second); 
+    if(mit1) {
+      //PRINT_ADDED_EDGE(mit1);
+      addSuccessor(mit1); 
     }
   }
   else if(fBranch) {
     tAddr = fBranch->getTakenAddr();
     ntAddr = fBranch->getNotTakenAddr();
-    mit0 = cfg->cfgBlockMap.find(tAddr);
-    mit1 = cfg->cfgBlockMap.find(ntAddr);
+    mit0 = cfg->findBlock(tAddr);
+    mit1 = cfg->findBlock(ntAddr);
 
-    if(mit0 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit0->second);
-      addSuccessor(mit0->second); 
+    if(mit0) {
+      //PRINT_ADDED_EDGE(mit0);
+      addSuccessor(mit0); 
     }
-    if(mit1 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit1->second);
-      addSuccessor(mit1->second); 
+    if(mit1) {
+      //PRINT_ADDED_EDGE(mit1);
+      addSuccessor(mit1); 
     }
   }
   else if(jJump) {
     tAddr = jJump->getJumpAddr();
-    mit0 = cfg->cfgBlockMap.find(tAddr);
-    if(mit0 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit0->second);
-      addSuccessor(mit0->second);
+    mit0 = cfg->findBlock(tAddr);
+    if(mit0) {
+      //PRINT_ADDED_EDGE(mit0);
+      addSuccessor(mit0);
     }
   }
   /* end-of-block with no branch or jump */
   else if(!jrInsn) {
     tAddr = getExitAddr()+4;
-    mit0 = cfg->cfgBlockMap.find(tAddr);
-    if(mit0 != cfg->cfgBlockMap.end()) {
-      //PRINT_ADDED_EDGE(mit0->second);
-      addSuccessor(mit0->second);
+    mit0 = cfg->findBlock(tAddr);
+    if(mit0) {
+      //PRINT_ADDED_EDGE(mit0);
+      addSuccessor(mit0);
     }
   }
 
@@ -121,52 +114,45 @@ void cfgBasicBlock::addSuccessor(cfgBasicBlock *s) {
 }
 
 void cfgBasicBlock::delSuccessor(cfgBasicBlock *s) {
-  std::set<cfgBasicBlock*>::iterator sit = succs.find(s);
-  succs.erase(sit);
-  sit = s->preds.find(this);
-  s->preds.erase(sit);
+  succs.erase(succs.find(s));
+  s->preds.erase(s->preds.find(this));
 }
 
 void cfgBasicBlock::addPhiNode(gprPhiNode *phi) {
   uint32_t r = phi->destRegister();
-  if(gprPhis[r])
-    delete phi;
-  else {
+  /* duplicates stay in the arena unused */
+  if(gprPhis[r] == nullptr) {
     phiNodes.push_back(phi);
     gprPhis[r] = phi;
   }
 }
 void cfgBasicBlock::addPhiNode(hiloPhiNode *phi) {
   uint32_t r = phi->destRegister();
-  if(hiLoPhis[r])
-    delete phi;
-  else {
+  /* duplicates stay in the arena unused */
+  if(hiLoPhis[r] == nullptr) {
     phiNodes.push_back(phi);
     hiLoPhis[r] = phi;
   }
 }
 void cfgBasicBlock::addPhiNode(fprPhiNode *phi) {
   uint32_t r = phi->destRegister();
-  if(fprPhis[r])
-    delete phi;
-  else {
+  /* duplicates stay in the arena unused */
+  if(fprPhis[r] == nullptr) {
     phiNodes.push_back(phi);
     fprPhis[r] = phi;
   }
 }
 void cfgBasicBlock::addPhiNode(fcrPhiNode *phi) {
   uint32_t r = phi->destRegister();
-  if(fcrPhis[r])
-    delete phi;
-  else {
+  /* duplicates stay in the arena unused */
+  if(fcrPhis[r] == nullptr) {
     phiNodes.push_back(phi);
     fcrPhis[r] = phi;
   }
 }
 void cfgBasicBlock::addPhiNode(icntPhiNode *phi) {
-  if(icntPhis[0])
-    delete phi;
-  else {
+  /* duplicates stay in the arena unused */
+  if(icntPhis[0] == nullptr) {
     phiNodes.push_back(phi);
     icntPhis[0] = phi;
   }
@@ -196,6 +182,20 @@ bool cfgBasicBlock::has_jr_jalr() {
   return false;
 }
 
+/* landing pad of a call whose callee isn't part of the
+ * function being compiled, zero if there's no such call */
+uint32_t cfgBasicBlock::nativeCallReturn(const regionCFG *cfg) const {
+  if(not(cfg->isFunction()) or (insns.size() < 2)) {
+    return 0;
+  }
+  jTypeInsn *jal = dynamic_cast<insn_jal*>(insns[insns.size()-2]);
+  if((jal == nullptr) or cfg->findBlock(jal->getJumpAddr())) {
+    return 0;
+  }
+  uint32_t retpc = jal->getAddr() + 8;
+  return cfg->findBlock(retpc) ? retpc : 0;
+}
+
 bool cfgBasicBlock::haslikely() {
   for(size_t i = 0; i < insns.size(); i++) {
     Insn *ins = insns[i];
@@ -303,7 +303,7 @@ bool cfgBasicBlock::patchLikely(regionCFG *cfg, cfgBasicBlock *pbb) {
   return patched;
 }
 
-cfgBasicBlock* cfgBasicBlock::splitBB(uint32_t splitpc) {
+cfgBasicBlock* cfgBasicBlock::splitBB(regionCFG *cfg, uint32_t splitpc) {
   assert(not(isLikelyPatch));
   ssize_t offs = -1;
 #if 0
@@ -315,7 +315,7 @@ cfgBasicBlock* cfgBasicBlock::splitBB(uint32_t splitpc) {
   }
 #endif
   
-  cfgBasicBlock *sbb = new cfgBasicBlock(bb, false);
+  cfgBasicBlock *sbb = cfg->newBlock(bb, false);
   sbb->rawInsns.clear();
   sbb->hasTermBranchOrJump = hasTermBranchOrJump;
 
@@ -423,15 +423,10 @@ cfgBasicBlock::cfgBasicBlock(basicBlock *bb, bool isLikelyPatch) :
 }
 
 void cfgBasicBlock::bindInsns(regionCFG *cfg) {
-  if(not(insns.empty())) {
-    for(size_t i = 0, n=insns.size(); i < n; i++) {
-      delete insns[i];
-    }
-    insns.clear();
-  }
-
+  insns.clear();
+  insns.reserve(rawInsns.size());
   for(const auto & p : rawInsns) {
-    Insn *ins = getInsn(p.first, p.second);
+    Insn *ins = getInsn(cfg->blockArena, p.first, p.second);
     ins->set(cfg,this);
     insns.push_back(ins);
   }
@@ -529,22 +524,27 @@ void cfgBasicBlock::traverseAndRename(regionCFG *cfg){
   cfg->myIRBuilder->SetInsertPoint(lBB);
   /* this only gets called for the entry block */
   llvmRegTables regTbl(cfg);
+  /* only what the region may read before writing it */
+  regSet live;
+  for(cfgBasicBlock *sbb : succs) {
+    live |= sbb->regsLiveIn;
+  }
   for(size_t i = 0; i < 32; i++) {
-    if(cfg->allGprRead[i] or not(cfg->gprDefinitionBlocks[i].empty())) {
+    if(live.gpr[i]) {
       regTbl.loadGPR(i);
     }
   }
-  if(cfg->allHiloRead[0] or not(cfg->hiloDefinitionBlocks.empty()) ) {
+  if(live.hilo) {
     regTbl.loadHiLo(0);
     regTbl.loadHiLo(1);
   }
   for(size_t i = 0; i < 32; i++) {
-    if(cfg->allFprRead[i] or not(cfg->fprDefinitionBlocks[i].empty())) {
+    if(live.fpr[i]) {
       regTbl.loadFPR(i);
     }
   }
   for(size_t i = 0; i < 5; i++) {
-    if(cfg->allFcrRead[i] or not(cfg->fcrDefinitionBlocks[i].empty())) {
+    if(live.fcr[i]) {
       regTbl.loadFCR(i);
     }
   }
@@ -600,6 +600,7 @@ void cfgBasicBlock::traverseAndRename(regionCFG *cfg, llvmRegTables prevRegTbl)
   if(globals::countInsns) {
     regTbl.incrIcnt(insns.size());
   }
+  cfg->countQuickInsns(insns.size());
 
   if(globals::simPoints and insns.size()) {
     if(cfg->builtinFuncts.find("log_bb") != cfg->builtinFuncts.end()) {
@@ -0,0 +1,282 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "codeHeap.hh"
+#include "helper.hh"
+
+codeHeap::area codeHeap::code, codeHeap::rodata, codeHeap::data;
+std::mutex codeHeap::mtx;
+size_t codeHeap::used = 0, codeHeap::peak = 0;
+thread_local bool codeHeap::cold = false;
+
+static const size_t hugePageSz = 1UL<<21;
+
+#ifdef __linux__
+/* a view of part of the arena file, starting on a huge page */
+static uint8_t *mapView(int fd, size_t offs, size_t len, int prot) {
+  void *r = mmap(nullptr, len + hugePageSz, PROT_NONE,
+		 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if(r == MAP_FAILED) {
+    return nullptr;
+  }
+  uint8_t *raw = reinterpret_cast<uint8_t*>(r);
+  uint8_t *aligned = reinterpret_cast<uint8_t*>(
+    (reinterpret_cast<uintptr_t>(raw) + hugePageSz - 1) & ~(hugePageSz-1));
+  if(aligned != raw) {
+    munmap(raw, aligned - raw);
+  }
+  munmap(aligned + len, (raw + len + hugePageSz) - (aligned + len));
+  if(mmap(aligned, len, prot, MAP_SHARED | MAP_FIXED, fd, offs) == MAP_FAILED) {
+    munmap(aligned, len);
+    return nullptr;
+  }
+  madvise(aligned, len, MADV_HUGEPAGE);
+  return aligned;
+}
+
+/* the arena file and its writable alias, a hugetlbfs file needs
+ * its pages reserved up front and plain shmem takes over without */
+static uint8_t *mapArena(size_t bytes, bool hugetlb, int &fd) {
+  for(int i = hugetlb ? 0 : 1; i < 2; i++) {
+    fd = memfd_create("codeHeap", MFD_CLOEXEC | (i == 0 ? (MFD_HUGETLB | (21 << MAP_HUGE_SHIFT)) : 0));
+    if(fd < 0) {
+      continue;
+    }
+    if(ftruncate(fd, bytes) == 0) {
+      uint8_t *alias = mapView(fd, 0, bytes, PROT_READ | PROT_WRITE);
+      if(alias) {
+	return alias;
+      }
+    }
+    close(fd);
+  }
+  return nullptr;
+}
+#endif
+
+bool codeHeap::init(size_t bytes, bool hugetlb) {
+#ifdef __linux__
+  bytes = std::max((bytes + hugePageSz - 1) & ~(hugePageSz-1), 4*hugePageSz);
+  int fd = -1;
+  uint8_t *alias = mapArena(bytes, hugetlb, fd);
+  if(alias == nullptr) {
+    return false;
+  }
+  /* a sixteenth each for read-only and writable data, whole
+   * huge pages so the code part keeps its own */
+  size_t dataLen = std::max(((bytes/16) + hugePageSz - 1) & ~(hugePageSz-1), hugePageSz);
+  size_t codeLen = bytes - 2*dataLen;
+  uint8_t *x = mapView(fd, 0, codeLen, PROT_READ | PROT_EXEC);
+  uint8_t *r = mapView(fd, codeLen, dataLen, PROT_READ);
+  /* the mappings keep the file alive */
+  close(fd);
+  if(x == nullptr or r == nullptr) {
+    munmap(alias, bytes);
+    if(x) {
+      munmap(x, codeLen);
+    }
+    if(r) {
+      munmap(r, dataLen);
+    }
+    return false;
+  }
+  code.base = x;
+  code.alias = alias;
+  code.len = codeLen;
+  rodata.base = r;
+  rodata.alias = alias + codeLen;
+  rodata.len = dataLen;
+  data.base = data.alias = alias + codeLen + dataLen;
+  data.len = dataLen;
+  code.freeList[0] = code.len;
+  rodata.freeList[0] = rodata.len;
+  data.freeList[0] = data.len;
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint8_t *codeHeap::area::carve(size_t sz, size_t align, bool fromTop) {
+  if(not(fromTop)) {
+    /* first fit from the bottom keeps hot code dense */
+    for(auto it = freeList.begin(); it != freeList.end(); ++it) {
+      size_t offs = it->first, flen = it->second;
+      size_t start = (offs + align - 1) & ~(align-1);
+      if(start + sz > offs + flen) {
+	continue;
+      }
+      freeList.erase(it);
+      if(start != offs) {
+	freeList[offs] = start - offs;
+      }
+      if(start + sz != offs + flen) {
+	freeList[start + sz] = (offs + flen) - (start + sz);
+      }
+      return base + start;
+    }
+  }
+  else {
+    /* baseline code is carved from the top, out of the way */
+    for(auto it = freeList.rbegin(); it != freeList.rend(); ++it) {
+      size_t offs = it->first, flen = it->second;
+      if(flen < sz) {
+	continue;
+      }
+      size_t start = (offs + flen - sz) & ~(align-1);
+      if(start < offs) {
+	continue;
+      }
+      freeList.erase(offs);
+      if(start != offs) {
+	freeList[offs] = start - offs;
+      }
+      if(start + sz != offs + flen) {
+	freeList[start + sz] = (offs + flen) - (start + sz);
+      }
+      return base + start;
+    }
+  }
+  return nullptr;
+}
+
+void codeHeap::area::release(uint8_t *p, size_t sz) {
+  size_t offs = p - base;
+  auto next = freeList.lower_bound(offs);
+  if(next != freeList.end() and next->first == offs + sz) {
+    sz += next->second;
+    next = freeList.erase(next);
+  }
+  if(next != freeList.begin()) {
+    auto prev = std::prev(next);
+    if(prev->first + prev->second == offs) {
+      prev->second += sz;
+      return;
+    }
+  }
+  freeList[offs] = sz;
+}
+
+uint8_t *codeHeap::take(area &a, size_t sz, size_t align, bool fromTop) {
+  std::unique_lock<std::mutex> lk(mtx);
+  sz = (sz + 15) & ~15UL;
+  uint8_t *p = a.carve(sz, align, fromTop);
+  if(p) {
+    used += sz;
+    peak = std::max(peak, used);
+  }
+  return p;
+}
+
+uint8_t *codeHeap::alloc(size_t sz, size_t align) {
+  return take(code, sz, align, cold);
+}
+
+uint8_t *codeHeap::allocData(size_t sz, size_t align, bool readOnly) {
+  return take(readOnly ? rodata : data, sz, align, false);
+}
+
+void codeHeap::release(uint8_t *p, size_t sz) {
+  std::unique_lock<std::mutex> lk(mtx);
+  sz = (sz + 15) & ~15UL;
+  used -= sz;
+  for(area *a : {&code, &rodata, &data}) {
+    if(a->contains(p)) {
+      a->release(p, sz);
+      return;
+    }
+  }
+}
+
+uint8_t *codeHeap::writable(uint8_t *p) {
+  for(const area *a : {&code, &rodata, &data}) {
+    if(a->contains(p)) {
+      return a->alias + (p - a->base);
+    }
+  }
+  return p;
+}
+
+codeHeapMM::~codeHeapMM() {
+  for(auto &b : blocks) {
+    codeHeap::release(b.first, b.second);
+  }
+  for(auto &m : overflow) {
+    munmap(m.p, m.len);
+  }
+}
+
+uint8_t *codeHeapMM::mapOverflow(uintptr_t sz, int prot) {
+  size_t mlen = (sz + 4095) & ~4095UL;
+  void *m = mmap(nullptr, mlen, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(m == MAP_FAILED) {
+    return nullptr;
+  }
+  overflow.push_back(mapping{reinterpret_cast<uint8_t*>(m), mlen, prot});
+  return reinterpret_cast<uint8_t*>(m);
+}
+
+uint8_t *codeHeapMM::fromHeap(uint8_t *p, uintptr_t sz) {
+  blocks.emplace_back(p, sz);
+  uint8_t *w = codeHeap::writable(p);
+  if(w != p) {
+    remap.emplace_back(w, p);
+  }
+  return w;
+}
+
+uint8_t *codeHeapMM::allocateCodeSection(uintptr_t sz, unsigned align, unsigned id,
+					 llvm::StringRef name) {
+  /* sections start on their own cache line */
+  uint8_t *p = codeHeap::alloc(sz, std::max<size_t>(align, 64));
+  if(p) {
+    return fromHeap(p, sz);
+  }
+  return mapOverflow(sz, PROT_READ | PROT_EXEC);
+}
+
+uint8_t *codeHeapMM::allocateDataSection(uintptr_t sz, unsigned align, unsigned id,
+					 llvm::StringRef name, bool readOnly) {
+  uint8_t *p = codeHeap::allocData(sz, std::max<size_t>(align, 16), readOnly);
+  if(p) {
+    return fromHeap(p, sz);
+  }
+  return mapOverflow(sz, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE));
+}
+
+void codeHeapMM::notifyObjectLoaded(llvm::RuntimeDyld &rtdyld,
+				    const llvm::object::ObjectFile &obj) {
+  /* sections were filled through the alias, relocate
+   * them against where they run */
+  for(auto &r : remap) {
+    rtdyld.mapSectionAddress(r.first, reinterpret_cast<uint64_t>(r.second));
+  }
+  remap.clear();
+}
+
+void codeHeapMM::registerEHFrames(uint8_t *addr, uint64_t loadAddr, size_t sz) {
+  /* the unwinder reads the frames at their final address */
+  llvm::RTDyldMemoryManager::registerEHFrames(reinterpret_cast<uint8_t*>(loadAddr),
+					      loadAddr, sz);
+}
+
+bool codeHeapMM::finalizeMemory(std::string *errMsg) {
+  /* heap sections already have their final protection */
+  for(auto &b : blocks) {
+    llvm::sys::Memory::InvalidateInstructionCache(b.first, b.second);
+  }
+  for(auto &m : overflow) {
+    if(mprotect(m.p, m.len, m.prot) != 0) {
+      if(errMsg) {
+	*errMsg = "codeHeapMM : mprotect failed";
+      }
+      return true;
+    }
+    if(m.prot & PROT_EXEC) {
+      llvm::sys::Memory::InvalidateInstructionCache(m.p, m.len);
+    }
+  }
+  return false;
+}
@@ -0,0 +1,94 @@
+#ifndef __CODE_HEAP_HH__
+#define __CODE_HEAP_HH__
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <mutex>
+
+#include "llvmInc.hh"
+
+/* one executable arena, backed by huge pages, holding the
+ * code of every compiled region. regions are packed from
+ * the bottom in the order they get hot, baseline blocks from
+ * the top, so hot code shares a handful of itlb entries.
+ * the arena is a memfd mapped twice: guest code runs from
+ * read-only views and the linker writes through a separate
+ * writable alias, so no page is ever writable and executable.
+ * read-only and writable data get their own areas after the code */
+class codeHeap {
+private:
+  /* free ranges, offset to length, coalesced on release */
+  struct area {
+    uint8_t *base = nullptr;
+    /* where the linker writes, base itself for writable data */
+    uint8_t *alias = nullptr;
+    size_t len = 0;
+    std::map<size_t, size_t> freeList;
+    uint8_t *carve(size_t sz, size_t align, bool fromTop);
+    void release(uint8_t *p, size_t sz);
+    bool contains(const uint8_t *p) const {
+      return (p >= base) and (p < base + len);
+    }
+  };
+  static area code, rodata, data;
+  static std::mutex mtx;
+  static size_t used, peak;
+  static uint8_t *take(area &a, size_t sz, size_t align, bool fromTop);
+public:
+  /* set by the compiling thread, the jit links on the
+   * thread that looks the region up */
+  static thread_local bool cold;
+  static bool init(size_t bytes, bool hugetlb);
+  static bool enabled() {
+    return code.base != nullptr;
+  }
+  static uint8_t *alloc(size_t sz, size_t align);
+  static uint8_t *allocData(size_t sz, size_t align, bool readOnly);
+  static void release(uint8_t *p, size_t sz);
+  /* the writable alias of a pointer handed out by alloc */
+  static uint8_t *writable(uint8_t *p);
+  static size_t inUse() {
+    return used;
+  }
+  static size_t peakUse() {
+    return peak;
+  }
+  static size_t size() {
+    return code.len + rodata.len + data.len;
+  }
+};
+
+/* per object memory manager, sections come from the code
+ * heap and go back to it when the region's dylib is removed */
+class codeHeapMM : public llvm::RTDyldMemoryManager {
+private:
+  std::vector<std::pair<uint8_t*, size_t>> blocks;
+  /* sections written through an alias, moved to
+   * their final address before relocation */
+  std::vector<std::pair<uint8_t*, uint8_t*>> remap;
+  /* private mappings once the heap is full, mapped writable
+   * and given their final protection when finalized */
+  struct mapping {
+    uint8_t *p;
+    size_t len;
+    int prot;
+  };
+  std::vector<mapping> overflow;
+  uint8_t *mapOverflow(uintptr_t sz, int prot);
+  uint8_t *fromHeap(uint8_t *p, uintptr_t sz);
+public:
+  codeHeapMM() {}
+  ~codeHeapMM();
+  uint8_t *allocateCodeSection(uintptr_t sz, unsigned align, unsigned id,
+			       llvm::StringRef name) override;
+  uint8_t *allocateDataSection(uintptr_t sz, unsigned align, unsigned id,
+			       llvm::StringRef name, bool readOnly) override;
+  void notifyObjectLoaded(llvm::RuntimeDyld &rtdyld,
+			  const llvm::object::ObjectFile &obj) override;
+  void registerEHFrames(uint8_t *addr, uint64_t loadAddr, size_t sz) override;
+  bool finalizeMemory(std::string *errMsg = nullptr) override;
+};
+
+#endif
@@ -14,6 +14,7 @@ namespace globals {
   extern int sArgc;
   extern char** sArgv;
   extern bool isMipsEL;
+  extern bool hostEndianMem;
   extern bool countInsns;
   extern bool simPoints;
   extern bool replay;
@@ -31,7 +32,14 @@ namespace globals {
   extern uint64_t nAttemptedFuses;
   extern bool enableBoth;
   extern uint32_t enoughRegions;
+  extern uint64_t blockJitThresh;
+  extern uint64_t tierUpIcnt;
+  extern double reformShare;
+  extern bool chainRegions;
+  extern uint32_t compileThreads;
+  extern uint32_t elfHash;
   extern bool dumpIR;
+  extern bool report;
   extern bool splitCFGBBs;
   extern std::string blobName;
   extern uint64_t icountMIPS;
@@ -40,6 +48,9 @@ namespace globals {
   extern std::set<int> openFileDes;
   extern bool profile;
   extern uint64_t dumpicnt;
+  extern std::string irPasses;
+  extern std::string jitCPU;
+  extern std::string jitFeatures;
 #ifndef ELIDE_LLVM
   extern llvm::CodeGenOpt::Level regionOptLevel;
 #endif
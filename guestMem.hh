@@ -0,0 +1,93 @@
+#ifndef __GUESTMEM_HH__
+#define __GUESTMEM_HH__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "helper.hh"
+#include "globals.hh"
+
+/* big-endian guest memory is kept either in guest byte order,
+ * swapped on every access, or (globals::hostEndianMem) as host
+ * order words: words then load without a swap, bytes and halfwords
+ * live at ea^3 and ea^2 and doublewords have their halves exchanged.
+ * the interpreter picks the layout once at dispatch, as HE next to
+ * EL, so its loads and stores never test the global */
+
+template <typename T>
+inline uint32_t hostEA(uint32_t ea) {
+  return sizeof(T) < 4 ? (ea ^ (4 - sizeof(T))) : ea;
+}
+
+template <typename T>
+inline T swapHalves(T x) {
+  uint64_t v = static_cast<uint64_t>(x);
+  return sizeof(T) == 8 ? static_cast<T>((v << 32) | (v >> 32)) : x;
+}
+
+template <bool EL, bool HE, typename T>
+inline T loadGuest(const uint8_t *mem, uint32_t ea) {
+  if(EL or not(HE)) {
+    return bswap<EL>(*reinterpret_cast<const T*>(mem + ea));
+  }
+  return swapHalves(*reinterpret_cast<const T*>(mem + hostEA<T>(ea)));
+}
+
+template <bool EL, bool HE, typename T>
+inline void storeGuest(uint8_t *mem, uint32_t ea, T v) {
+  if(EL or not(HE)) {
+    *reinterpret_cast<T*>(mem + ea) = bswap<EL>(v);
+  }
+  else {
+    *reinterpret_cast<T*>(mem + hostEA<T>(ea)) = swapHalves(v);
+  }
+}
+
+/* byte strings crossing the guest boundary (loader, syscalls) */
+inline void copyToGuest(uint8_t *mem, uint32_t ea, const void *src, size_t len) {
+  const uint8_t *b = reinterpret_cast<const uint8_t*>(src);
+  if(not(globals::hostEndianMem)) {
+    memcpy(mem + ea, b, len);
+    return;
+  }
+  for(size_t i = 0; i < len; i++) {
+    mem[(ea + i) ^ 3] = b[i];
+  }
+}
+
+inline void copyFromGuest(void *dst, const uint8_t *mem, uint32_t ea, size_t len) {
+  uint8_t *b = reinterpret_cast<uint8_t*>(dst);
+  if(not(globals::hostEndianMem)) {
+    memcpy(b, mem + ea, len);
+    return;
+  }
+  for(size_t i = 0; i < len; i++) {
+    b[i] = mem[(ea + i) ^ 3];
+  }
+}
+
+inline std::string guestString(const uint8_t *mem, uint32_t ea) {
+  if(not(globals::hostEndianMem)) {
+    return std::string(reinterpret_cast<const char*>(mem + ea));
+  }
+  std::string str;
+  for(char c; (c = static_cast<char>(mem[ea ^ 3])) != '\0'; ea++) {
+    str.push_back(c);
+  }
+  return str;
+}
+
+/* converts a word aligned buffer between guest and host word order,
+ * the conversion is its own inverse */
+inline void swapGuestWords(uint8_t *buf, size_t len) {
+  if(not(globals::hostEndianMem)) {
+    return;
+  }
+  uint32_t *w = reinterpret_cast<uint32_t*>(buf);
+  for(size_t i = 0; i < len/4; i++) {
+    w[i] = __builtin_bswap32(w[i]);
+  }
+}
+
+#endif
@@ -15,14 +15,15 @@
 #include "state.hh"        // for state_t, operator<<
 #define ELIDE_LLVM
 #include "globals.hh"      // for cBB, blobName, isMipsEL
+#include "guestMem.hh"     // for loadGuest, storeGuest
 #include "monitor.hh"      // for _monitor, getNextBlock
 
-template <bool appendIns, bool EL> void execMips(state_t *s);
-template<bool EL> void _lwl(uint32_t inst, state_t *s);
-template<bool EL> void _lwr(uint32_t inst, state_t *s);
-template<bool EL> void _swl(uint32_t inst, state_t *s);
-template<bool EL> void _swr(uint32_t inst, state_t *s);
-template<bool EL> void _sc(uint32_t inst, state_t *s);
+template <bool appendIns, bool EL, bool HE> void execMips(state_t *s);
+template<bool EL, bool HE> void _lwl(uint32_t inst, state_t *s);
+template<bool EL, bool HE> void _lwr(uint32_t inst, state_t *s);
+template<bool EL, bool HE> void _swl(uint32_t inst, state_t *s);
+template<bool EL, bool HE> void _swr(uint32_t inst, state_t *s);
+template<bool EL, bool HE> void _sc(uint32_t inst, state_t *s);
 
 static void _c(uint32_t inst, state_t *s);
 static void _truncw(uint32_t inst, state_t *s);
@@ -39,15 +40,15 @@ static void getNextBlock(state_t *s) {
   globals::cBB = nBB;
 }
 
-template<typename T, bool isLoad, bool EL>
+template<typename T, bool isLoad, bool EL, bool HE>
 void fpMemOp(uint32_t inst, state_t *s) {
   uint32_t ft=(inst>>16)&31,rs=(inst>>21)&31;
   int32_t imm = static_cast<int32_t>(static_cast<int16_t>(inst & ((1<<16) - 1)));
   uint32_t ea = s->gpr[rs] + imm;
   if(isLoad)
-    *reinterpret_cast<T*>(s->cpr1 + ft) = bswap<EL>(*reinterpret_cast<T*>(s->mem + ea));
+    *reinterpret_cast<T*>(s->cpr1 + ft) = loadGuest<EL,HE,T>(s->mem, ea);
   else
-    *reinterpret_cast<T*>(s->mem + ea) = bswap<EL>(*reinterpret_cast<T*>(s->cpr1 + ft));
+    storeGuest<EL,HE,T>(s->mem, ea, *reinterpret_cast<T*>(s->cpr1 + ft));
   s->pc += 4;
 }
 
@@ -111,7 +112,7 @@ void do_fp_op(uint32_t inst, state_t *s) {
 }
 
 
-template <bool appendIns, bool EL>
+template <bool appendIns, bool EL, bool HE>
 void _bgez_bltz(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   int32_t npc = s->pc+4;
@@ -120,7 +121,7 @@ void _bgez_bltz(uint32_t inst, state_t *s) {
   if(mi.i.rt==0 || mi.i.rt==1) {
     takeBranch = mi.i.rt==0 ? (s->gpr[mi.i.rs] < 0) : (s->gpr[mi.i.rs] >= 0);
     s->pc += 4;
-    execMips<appendIns,EL>(s);
+    execMips<appendIns,EL,HE>(s);
     s->pc = takeBranch ? (signExtendImm(mi.i)<<2)+npc : s->pc;
   }
   else if(mi.i.rt==2 || mi.i.rt==3) {
@@ -128,12 +129,12 @@ void _bgez_bltz(uint32_t inst, state_t *s) {
     takeBranch = mi.i.rt==2 ? (s->gpr[mi.i.rs] < 0) : (s->gpr[mi.i.rs] >= 0);
     s->pc += 4;
     if(takeBranch) {
-      execMips<appendIns,EL>(s);
+      execMips<appendIns,EL,HE>(s);
       s->pc = (signExtendImm(mi.i)<<2)+npc;
     }
     else {
       if(appendIns) {
-	uint32_t bInst = bswap<EL>(*(uint32_t*)(s->mem + s->pc));
+	uint32_t bInst = loadGuest<EL,HE,uint32_t>(s->mem, s->pc);
 	globals::cBB->addIns(bInst, s->pc);
       }
       s->pc += 4;
@@ -142,7 +143,7 @@ void _bgez_bltz(uint32_t inst, state_t *s) {
   getNextBlock(s);
 }
 
-template<branchOperation op, bool appendIns, bool EL>
+template<branchOperation op, bool appendIns, bool EL, bool HE>
 void branch(uint32_t inst, state_t *s) {
   mips_t mi(inst);  
   if(appendIns) {
@@ -168,13 +169,13 @@ void branch(uint32_t inst, state_t *s) {
       UNREACHABLE();
     }
   s->pc += 4;
-  execMips<appendIns,EL>(s);
+  execMips<appendIns,EL,HE>(s);
   if(takeBranch)
     s->pc = (signExtendImm(mi.i)<<2)+npc;
   getNextBlock(s);
 }
 
-template<branchLikelyOperation op, bool appendIns, bool EL>
+template<branchLikelyOperation op, bool appendIns, bool EL, bool HE>
 void branchLikely(uint32_t inst, state_t *s) {
   mips_t mi(inst);    
   int32_t npc = s->pc+4; 
@@ -202,12 +203,12 @@ void branchLikely(uint32_t inst, state_t *s) {
       UNREACHABLE();
     }
   if(takeBranch) {
-    execMips<appendIns,EL>(s);
+    execMips<appendIns,EL,HE>(s);
     s->pc = ((signExtendImm(mi.i)<<2)+npc);
   }
   else {
     if(appendIns) {
-      uint32_t bInst = bswap<EL>(*reinterpret_cast<uint32_t*>(s->mem + s->pc));
+      uint32_t bInst = loadGuest<EL,HE,uint32_t>(s->mem, s->pc);
       globals::cBB->addIns(bInst, s->pc);
     }
     s->pc += 4;
@@ -216,29 +217,29 @@ void branchLikely(uint32_t inst, state_t *s) {
 }
 
 
-template <bool EL, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
+template <bool EL, bool HE, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
 void itype_loadu_helper(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   uint32_t ea = s->gpr[mi.i.rs] + signExtendImm(mi.i);
-  *reinterpret_cast<uint32_t*>(s->gpr + mi.i.rt) = bswap<EL>(*reinterpret_cast<T*>(s->mem + ea));
+  *reinterpret_cast<uint32_t*>(s->gpr + mi.i.rt) = loadGuest<EL,HE,T>(s->mem, ea);
   s->pc += 4;
 }
 
 
-template<bool EL, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
+template<bool EL, bool HE, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
 void itype_load_helper(mips_t mi, state_t *s) {
   uint32_t ea = static_cast<uint32_t>(s->gpr[mi.i.rs]) + signExtendImm(mi.i);
-  T mem = bswap<EL>(*(reinterpret_cast<T*>(s->mem + ea)));
+  T mem = loadGuest<EL,HE,T>(s->mem, ea);
   s->gpr[mi.i.rt] = static_cast<int32_t>(mem);
 }
 
-template<bool EL, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
+template<bool EL, bool HE, typename T, typename std::enable_if<std::is_integral<T>::value, T>::type* = nullptr>
 void itype_store_helper(mips_t mi, state_t *s) {
   uint32_t ea = static_cast<uint32_t>(s->gpr[mi.i.rs]) + signExtendImm(mi.i);
-  *reinterpret_cast<T*>(s->mem+ea) = bswap<EL,T>(static_cast<T>(s->gpr[mi.i.rt]));
+  storeGuest<EL,HE,T>(s->mem, ea, static_cast<T>(s->gpr[mi.i.rt]));
 }
 
-template<itypeOperation op, bool EL>
+template<itypeOperation op, bool EL, bool HE>
 void exec_itype(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   bool bump_pc = true;
@@ -274,22 +275,22 @@ void exec_itype(uint32_t inst, state_t *s) {
       s->gpr[mi.i.rt] = static_cast<uint32_t>(s->gpr[mi.i.rs]) < static_cast<uint32_t>(imm32);
       break;
     case itypeOperation::_lb:
-      itype_load_helper<EL,int8_t>(mi, s);
+      itype_load_helper<EL,HE,int8_t>(mi, s);
       break;
     case itypeOperation::_lh:
-      itype_load_helper<EL,int16_t>(mi, s);
+      itype_load_helper<EL,HE,int16_t>(mi, s);
       break;
     case itypeOperation::_lw:
-      itype_load_helper<EL,int32_t>(mi, s);
+      itype_load_helper<EL,HE,int32_t>(mi, s);
       break;
     case itypeOperation::_sw:
-      itype_store_helper<EL,int32_t>(mi, s);
+      itype_store_helper<EL,HE,int32_t>(mi, s);
       break;
     case itypeOperation::_sh:
-      itype_store_helper<EL, int16_t>(mi, s);
+      itype_store_helper<EL,HE, int16_t>(mi, s);
       break;
     case itypeOperation::_sb:
-      itype_store_helper<EL,int8_t>(mi, s);
+      itype_store_helper<EL,HE,int8_t>(mi, s);
       break;
     default:
       UNREACHABLE();
@@ -299,7 +300,7 @@ void exec_itype(uint32_t inst, state_t *s) {
   }
 }
 
-template<rtypeOperation op, bool appendIns, bool EL>
+template<rtypeOperation op, bool appendIns, bool EL, bool HE>
 void exec_rtype(uint32_t inst, state_t* s) {
   mips_t mi(inst);
   int32_t rs = s->gpr[mi.r.rs], rt = s->gpr[mi.r.rt];
@@ -440,7 +441,7 @@ void exec_rtype(uint32_t inst, state_t* s) {
       s->gpr[31] = s->pc+8;
       globals::cBB->setTermAddr(s->pc);
       s->pc += 4;
-      execMips<appendIns,EL>(s);
+      execMips<appendIns,EL,HE>(s);
       s->pc = jaddr;
       getNextBlock(s);
       bump_pc = false;
@@ -450,7 +451,7 @@ void exec_rtype(uint32_t inst, state_t* s) {
       uint32_t jaddr = s->gpr[mi.r.rs];
       globals::cBB->setTermAddr(s->pc);
       s->pc += 4;
-      execMips<appendIns,EL>(s);
+      execMips<appendIns,EL,HE>(s);
       s->pc = jaddr;
       getNextBlock(s);
       bump_pc = false;
@@ -562,112 +563,112 @@ void execSpecial3(uint32_t inst,state_t *s) {
 }
 
 
-template <bool appendIns,bool EL>
+template <bool appendIns,bool EL, bool HE>
 void execRType(uint32_t inst,state_t *s) {
   mips_t mi(inst);
   switch(mi.r.opcode)
     {
     case 0x00:
-      exec_rtype<rtypeOperation::_sll,appendIns,EL>(inst, s);
+      exec_rtype<rtypeOperation::_sll,appendIns,EL,HE>(inst, s);
       break;
     case 0x01:
-      exec_rtype<rtypeOperation::_movci,appendIns,EL>(inst, s);
+      exec_rtype<rtypeOperation::_movci,appendIns,EL,HE>(inst, s);
       break;
     case 0x02:
-      exec_rtype<rtypeOperation::_srl,appendIns,EL>(inst, s);
+      exec_rtype<rtypeOperation::_srl,appendIns,EL,HE>(inst, s);
       break;
     case 0x03:
-      exec_rtype<rtypeOperation::_sra,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_sra,appendIns,EL,HE>(inst,s);
       break;
     case 0x04:
-      exec_rtype<rtypeOperation::_sllv,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_sllv,appendIns,EL,HE>(inst,s);
       break;
     case 0x05:
-      _monitor<EL>(inst,s);
+      _monitor<EL,HE>(inst,s);
       break;
     case 0x06:
-      exec_rtype<rtypeOperation::_srlv,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_srlv,appendIns,EL,HE>(inst,s);
       break;
     case 0x07:
-      exec_rtype<rtypeOperation::_srav,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_srav,appendIns,EL,HE>(inst,s);
       break;
     case 0x08:
-      exec_rtype<rtypeOperation::_jr,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_jr,appendIns,EL,HE>(inst,s);
       break;
     case 0x09:
-      exec_rtype<rtypeOperation::_jalr,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_jalr,appendIns,EL,HE>(inst,s);
       break;
     case 0x0C:
-      exec_rtype<rtypeOperation::_syscall,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_syscall,appendIns,EL,HE>(inst,s);
       break;
     case 0x0D:
-      exec_rtype<rtypeOperation::_break,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_break,appendIns,EL,HE>(inst,s);
       break;
     case 0x0f:
-      exec_rtype<rtypeOperation::_sync,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_sync,appendIns,EL,HE>(inst,s);
       break;
     case 0x10:
-      exec_rtype<rtypeOperation::_mfhi,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_mfhi,appendIns,EL,HE>(inst,s);
       break;
     case 0x11:
-      exec_rtype<rtypeOperation::_mthi,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_mthi,appendIns,EL,HE>(inst,s);
       break;
     case 0x12:
-      exec_rtype<rtypeOperation::_mflo,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_mflo,appendIns,EL,HE>(inst,s);
       break;
     case 0x13:
-      exec_rtype<rtypeOperation::_mtlo,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_mtlo,appendIns,EL,HE>(inst,s);
       break;
     case 0x18:
-      exec_rtype<rtypeOperation::_mult,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_mult,appendIns,EL,HE>(inst,s);
       break;
     case 0x19:
-      exec_rtype<rtypeOperation::_multu,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_multu,appendIns,EL,HE>(inst,s);
       break;
     case 0x1A:
-      exec_rtype<rtypeOperation::_div,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_div,appendIns,EL,HE>(inst,s);
       break;
     case 0x1B:
-      exec_rtype<rtypeOperation::_divu,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_divu,appendIns,EL,HE>(inst,s);
       break;
     case 0x20:
-      exec_rtype<rtypeOperation::_add,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_add,appendIns,EL,HE>(inst,s);
       break;
     case 0x21:
-      exec_rtype<rtypeOperation::_addu,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_addu,appendIns,EL,HE>(inst,s);
       break;
     case 0x22:
-      exec_rtype<rtypeOperation::_sub,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_sub,appendIns,EL,HE>(inst,s);
       break;
     case 0x23:
-      exec_rtype<rtypeOperation::_subu,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_subu,appendIns,EL,HE>(inst,s);
       break;
     case 0x24:
-      exec_rtype<rtypeOperation::_and,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_and,appendIns,EL,HE>(inst,s);
       break;
     case 0x25:
-      exec_rtype<rtypeOperation::_or,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_or,appendIns,EL,HE>(inst,s);
       break;
     case 0x26:
-      exec_rtype<rtypeOperation::_xor,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_xor,appendIns,EL,HE>(inst,s);
       break;
     case 0x27:
-      exec_rtype<rtypeOperation::_nor,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_nor,appendIns,EL,HE>(inst,s);
       break;
     case 0x2A:
-      exec_rtype<rtypeOperation::_slt,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_slt,appendIns,EL,HE>(inst,s);
       break;
     case 0x2B: 
-      exec_rtype<rtypeOperation::_sltu,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_sltu,appendIns,EL,HE>(inst,s);
       break;
     case 0x0B:
-      exec_rtype<rtypeOperation::_movn,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_movn,appendIns,EL,HE>(inst,s);
       break;
     case 0x0A:
-      exec_rtype<rtypeOperation::_movz,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_movz,appendIns,EL,HE>(inst,s);
       break;
     case 0x34:
-      exec_rtype<rtypeOperation::_teq,appendIns,EL>(inst,s);
+      exec_rtype<rtypeOperation::_teq,appendIns,EL,HE>(inst,s);
       break;
     default:
       std::cerr << *s << "\n";      
@@ -675,7 +676,7 @@ void execRType(uint32_t inst,state_t *s) {
     }
 }
 
-template <jumpOperation op, bool appendIns, bool EL>
+template <jumpOperation op, bool appendIns, bool EL, bool HE>
 void jump(uint32_t inst, state_t *s) {
   globals::cBB->setTermAddr(s->pc);
   uint32_t jaddr = (inst & ((1<<26)-1)) << 2;
@@ -684,126 +685,126 @@ void jump(uint32_t inst, state_t *s) {
   }
   s->pc += 4;
   jaddr |= (s->pc & (~((1<<28)-1)));
-  execMips<appendIns,EL>(s);
+  execMips<appendIns,EL,HE>(s);
   s->pc = jaddr;
   getNextBlock(s);
 }
 
-template <bool appendIns, bool EL>
+template <bool appendIns, bool EL, bool HE>
 void execJType(uint32_t inst, state_t *s) {
   uint32_t opcode = inst>>26;
   if(opcode==0x2)
-    jump<jumpOperation::_j,appendIns,EL>(inst,s);
+    jump<jumpOperation::_j,appendIns,EL,HE>(inst,s);
   else if(opcode==0x3)
-    jump<jumpOperation::_jal,appendIns,EL>(inst, s);
+    jump<jumpOperation::_jal,appendIns,EL,HE>(inst, s);
   else
     UNREACHABLE();
 }
 
 
-template <bool appendIns, bool EL>
+template <bool appendIns, bool EL, bool HE>
 void execIType(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   switch(mi.i.opcode)
     {
     case 0x01:
-      _bgez_bltz<appendIns,EL>(inst,s);
+      _bgez_bltz<appendIns,EL,HE>(inst,s);
       break;
     case 0x04:
-      branch<branchOperation::_beq,appendIns,EL>(inst, s);
+      branch<branchOperation::_beq,appendIns,EL,HE>(inst, s);
       break;
     case 0x05:
-      branch<branchOperation::_bne,appendIns,EL>(inst, s);
+      branch<branchOperation::_bne,appendIns,EL,HE>(inst, s);
       break;
     case 0x06:
-      branch<branchOperation::_blez,appendIns,EL>(inst, s);
+      branch<branchOperation::_blez,appendIns,EL,HE>(inst, s);
       break;
     case 0x07:
-      branch<branchOperation::_bgtz,appendIns,EL>(inst, s);
+      branch<branchOperation::_bgtz,appendIns,EL,HE>(inst, s);
       break;
     case 0x08:
-      exec_itype<itypeOperation::_addi,EL>(inst,s);
+      exec_itype<itypeOperation::_addi,EL,HE>(inst,s);
       break;
     case 0x09:
-      exec_itype<itypeOperation::_addiu,EL>(inst,s);
+      exec_itype<itypeOperation::_addiu,EL,HE>(inst,s);
       break;
     case 0x0a:
-      exec_itype<itypeOperation::_slti,EL>(inst,s);
+      exec_itype<itypeOperation::_slti,EL,HE>(inst,s);
       break;
     case 0x0b:
-      exec_itype<itypeOperation::_sltiu,EL>(inst,s);
+      exec_itype<itypeOperation::_sltiu,EL,HE>(inst,s);
       break;
     case 0x0c:
-      exec_itype<itypeOperation::_andi,EL>(inst,s);
+      exec_itype<itypeOperation::_andi,EL,HE>(inst,s);
       break;
     case 0x0d:
-      exec_itype<itypeOperation::_ori,EL>(inst,s);
+      exec_itype<itypeOperation::_ori,EL,HE>(inst,s);
       break;
     case 0x0e:
-      exec_itype<itypeOperation::_xori,EL>(inst,s);
+      exec_itype<itypeOperation::_xori,EL,HE>(inst,s);
       break;
     case 0x0f:
-      exec_itype<itypeOperation::_lui,EL>(inst,s);
+      exec_itype<itypeOperation::_lui,EL,HE>(inst,s);
       break;
     case 0x14:
-      branchLikely<branchLikelyOperation::_beql,appendIns,EL>(inst, s);
+      branchLikely<branchLikelyOperation::_beql,appendIns,EL,HE>(inst, s);
       break;
     case 0x15:
-      branchLikely<branchLikelyOperation::_bnel,appendIns,EL>(inst, s);
+      branchLikely<branchLikelyOperation::_bnel,appendIns,EL,HE>(inst, s);
       break;
     case 0x16:
-      branchLikely<branchLikelyOperation::_blezl,appendIns,EL>(inst, s);
+      branchLikely<branchLikelyOperation::_blezl,appendIns,EL,HE>(inst, s);
       break;
     case 0x17:
-      branchLikely<branchLikelyOperation::_bgtzl,appendIns,EL>(inst, s);
+      branchLikely<branchLikelyOperation::_bgtzl,appendIns,EL,HE>(inst, s);
       break;
     case 0x20:
-      exec_itype<itypeOperation::_lb,EL>(inst,s);
+      exec_itype<itypeOperation::_lb,EL,HE>(inst,s);
       break;
     case 0x21:
-      exec_itype<itypeOperation::_lh,EL>(inst,s);
+      exec_itype<itypeOperation::_lh,EL,HE>(inst,s);
       break;
     case 0x22:
-      _lwl<EL>(inst,s);
+      _lwl<EL,HE>(inst,s);
       break;
     case 0x23:
-      exec_itype<itypeOperation::_lw,EL>(inst,s);
+      exec_itype<itypeOperation::_lw,EL,HE>(inst,s);
       break;
     case 0x24: 
-      itype_loadu_helper<EL,uint8_t>(inst,s);
+      itype_loadu_helper<EL,HE,uint8_t>(inst,s);
       break;
     case 0x25:
-      itype_loadu_helper<EL,uint16_t>(inst,s);      
+      itype_loadu_helper<EL,HE,uint16_t>(inst,s);      
       break;
     case 0x26:
-      _lwr<EL>(inst,s);
+      _lwr<EL,HE>(inst,s);
       break;
     case 0x28:
-      exec_itype<itypeOperation::_sb,EL>(inst,s);
+      exec_itype<itypeOperation::_sb,EL,HE>(inst,s);
       break;
     case 0x29:
-      exec_itype<itypeOperation::_sh,EL>(inst,s);
+      exec_itype<itypeOperation::_sh,EL,HE>(inst,s);
       break;
     case 0x2a:
-      _swl<EL>(inst,s);
+      _swl<EL,HE>(inst,s);
       break;
     case 0x2b:
-      exec_itype<itypeOperation::_sw,EL>(inst,s);
+      exec_itype<itypeOperation::_sw,EL,HE>(inst,s);
       break;
     case 0x2e:
-      _swr<EL>(inst,s);
+      _swr<EL,HE>(inst,s);
       break;
     case 0x31:
-      fpMemOp<int32_t, true, EL>(inst, s);
+      fpMemOp<int32_t, true, EL, HE>(inst, s);
       break;
     case 0x35:
-      fpMemOp<int64_t, true, EL>(inst, s);
+      fpMemOp<int64_t, true, EL, HE>(inst, s);
       break;
     case 0x39:
-      fpMemOp<int32_t, false, EL>(inst, s);
+      fpMemOp<int32_t, false, EL, HE>(inst, s);
       break;
     case 0x3d:
-      fpMemOp<int64_t, false, EL>(inst, s);
+      fpMemOp<int64_t, false, EL, HE>(inst, s);
       break;
     default:
       UNREACHABLE();
@@ -826,7 +827,7 @@ void execCoproc0(uint32_t inst, state_t *s) {
   s->pc += 4;
 }
 
-template <bool polarity, bool appendIns, bool EL>
+template <bool polarity, bool appendIns, bool EL, bool HE>
 void _bc1(uint32_t inst, state_t *s) {
   globals::cBB->setTermAddr(s->pc);
   int16_t himm = (int16_t)(inst & ((1<<16) - 1));
@@ -834,13 +835,13 @@ void _bc1(uint32_t inst, state_t *s) {
   uint32_t cc = (inst >> 18) & 7;
   bool takeBranch = extractBit(s->fcr1[CP1_CR25], cc)==polarity;
   s->pc += 4;
-  execMips<appendIns,EL>(s);
+  execMips<appendIns,EL,HE>(s);
   if(takeBranch)
     s->pc = npc;
   getNextBlock(s);
 }
 
-template <bool polarity, bool appendIns, bool EL>
+template <bool polarity, bool appendIns, bool EL, bool HE>
 void _bc1l(uint32_t inst, state_t *s) {
   globals::cBB->setTermAddr(s->pc);
   globals::cBB->setBranchLikely();
@@ -850,12 +851,12 @@ void _bc1l(uint32_t inst, state_t *s) {
   bool takeBranch = extractBit(s->fcr1[CP1_CR25], cc)==polarity;
   s->pc +=4;
   if(takeBranch) {
-    execMips<appendIns,EL>(s);
+    execMips<appendIns,EL,HE>(s);
     s->pc = npc;
   }
   else {
     if(appendIns) {
-      uint32_t bInst = bswap<EL>(*(uint32_t*)(s->mem + s->pc));
+      uint32_t bInst = loadGuest<EL,HE,uint32_t>(s->mem, s->pc);
       globals::cBB->addIns(bInst, s->pc);
     }
     s->pc += 4;
@@ -863,7 +864,7 @@ void _bc1l(uint32_t inst, state_t *s) {
   getNextBlock(s);
 }
 
-template <bool appendIns, bool EL>
+template <bool appendIns, bool EL, bool HE>
 void execCoproc1(uint32_t inst, state_t *s) {
   uint32_t opcode = inst>>26;
   uint32_t functField = (inst>>21) & 31;
@@ -878,16 +879,16 @@ void execCoproc1(uint32_t inst, state_t *s) {
     switch(nd_tf)
       {
       case 0x0:
-	_bc1<false,appendIns,EL>(inst,s);
+	_bc1<false,appendIns,EL,HE>(inst,s);
 	break;
       case 0x1:
-	_bc1<true,appendIns,EL>(inst,s);
+	_bc1<true,appendIns,EL,HE>(inst,s);
 	break;
       case 0x2:
-	_bc1l<false,appendIns,EL>(inst,s);
+	_bc1l<false,appendIns,EL,HE>(inst,s);
 	break;
       case 0x3:
-	_bc1l<true,appendIns,EL>(inst,s);
+	_bc1l<true,appendIns,EL,HE>(inst,s);
 	break;
       }
   }
@@ -1022,16 +1023,16 @@ struct c1xExec {
 };
 
 
-template <bool EL, typename T>
+template <bool EL, bool HE, typename T>
 void lxc1(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   uint32_t ea = s->gpr[mi.lc1x.base] + s->gpr[mi.lc1x.index];
-  *reinterpret_cast<T*>(s->cpr1 + mi.lc1x.fd) = bswap<EL>(*reinterpret_cast<T*>(s->mem + ea));
+  *reinterpret_cast<T*>(s->cpr1 + mi.lc1x.fd) = loadGuest<EL,HE,T>(s->mem, ea);
   s->pc += 4;
 }
 
 
-template <bool appendIns,bool EL>
+template <bool appendIns,bool EL, bool HE>
 void execCoproc1x(uint32_t inst, state_t *s) {
   mips_t mi(inst);
 
@@ -1039,11 +1040,11 @@ void execCoproc1x(uint32_t inst, state_t *s) {
     {
     case 0:
       //lwxc1
-      lxc1<EL,int32_t>(inst, s);
+      lxc1<EL,HE,int32_t>(inst, s);
       return;
     case 1:
       //ldxc1
-      lxc1<EL,int64_t>(inst, s);
+      lxc1<EL,HE,int64_t>(inst, s);
       return;
     default:
       break;
@@ -1072,10 +1073,10 @@ void execCoproc1x(uint32_t inst, state_t *s) {
 
 
 
-template <bool EL>
+template <bool EL, bool HE>
 void _sc(uint32_t inst, state_t *s) {
   mips_t mi(inst);
-  itype_store_helper<EL,int32_t>(mi, s);
+  itype_store_helper<EL,HE,int32_t>(mi, s);
   s->gpr[mi.i.rt] = 1;
   s->pc += 4;
 }
@@ -1088,13 +1089,21 @@ void mkMonitorVectors(state_t *s) {
 			 (((loop >> 2) & RSVD_INSTRUCTION_ARG_MASK)
 			  << RSVD_INSTRUCTION_ARG_SHIFT));
       /* printf("reserved isns = %x\n", insn); */
-      *(uint32_t*)(s->mem+vaddr) = globals::isMipsEL ? bswap<true>(insn) : bswap<false>(insn);
+      if(globals::isMipsEL) {
+	storeGuest<true,false,uint32_t>(s->mem, vaddr, insn);
+      }
+      else if(globals::hostEndianMem) {
+	storeGuest<false,true,uint32_t>(s->mem, vaddr, insn);
+      }
+      else {
+	storeGuest<false,false,uint32_t>(s->mem, vaddr, insn);
+      }
   }
 }
 
 
 
-template <bool EL>
+template <bool EL, bool HE>
 void _swl(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   uint32_t ea = s->gpr[mi.i.rs] + signExtendImm(mi.i);
@@ -1103,17 +1112,17 @@ void _swl(uint32_t inst, state_t *s) {
   if(EL) {
     ma = 3 - ma;
   }
-  uint32_t r = bswap<EL>(*((int32_t*)(s->mem + ea))); 
+  uint32_t r = loadGuest<EL,HE,uint32_t>(s->mem, ea);
   uint32_t xx=0,x = s->gpr[mi.i.rt];
   
   uint32_t xs = x >> (8*ma);
   uint32_t m = ~((1U << (8*(4 - ma))) - 1);
   xx = (r & m) | xs;
-  *reinterpret_cast<uint32_t*>(s->mem + ea) = bswap<EL>(xx);
+  storeGuest<EL,HE,uint32_t>(s->mem, ea, xx);
   s->pc += 4;
 }
 
-template <bool EL>
+template <bool EL, bool HE>
 void _swr(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   uint32_t ea = s->gpr[mi.i.rs] + signExtendImm(mi.i);
@@ -1122,18 +1131,18 @@ void _swr(uint32_t inst, state_t *s) {
     ma = 3 - ma;
   }
   ea &= 0xfffffffc;
-  uint32_t r = bswap<EL>(*((int32_t*)(s->mem + ea))); 
+  uint32_t r = loadGuest<EL,HE,uint32_t>(s->mem, ea);
   uint32_t xx=0,x = s->gpr[mi.i.rt];
   
   uint32_t xs = 8*(3-ma);
   uint32_t rm = (1U << xs) - 1;
 
   xx = (x << xs) | (rm & r);
-  *reinterpret_cast<uint32_t*>(s->mem + ea) = bswap<EL>(xx);
+  storeGuest<EL,HE,uint32_t>(s->mem, ea, xx);
   s->pc += 4;
 }
 
-template <bool EL>
+template <bool EL, bool HE>
 void _lwl(uint32_t inst, state_t *s) {
   mips_t mi(inst);
   uint32_t ea = ((uint32_t)s->gpr[mi.i.rs] + signExtendImm(mi.i));
@@ -1142,7 +1151,7 @@ void _lwl(uint32_t inst, state_t *s) {
   if(EL) {
     ma = 3 - ma;
   }
-  int32_t r = bswap<EL>(*((int32_t*)(s->mem + ea))); 
+  int32_t r = loadGuest<EL,HE,int32_t>(s->mem, ea);
   switch(ma&3)
     {
     case 0:
@@ -1161,7 +1170,7 @@ void _lwl(uint32_t inst, state_t *s) {
   s->pc += 4;
 }
 
-template <bool EL>
+template <bool EL, bool HE>
 void _lwr(uint32_t inst, state_t *s) {
   mips_t mi(inst);  
   uint32_t ea = ((uint32_t)s->gpr[mi.i.rs] + signExtendImm(mi.i));
@@ -1170,7 +1179,7 @@ void _lwr(uint32_t inst, state_t *s) {
   if(EL) {
     ma = 3-ma;
   }
-  uint32_t r = bswap<EL>(*reinterpret_cast<int32_t*>(s->mem + ea)); 
+  uint32_t r = loadGuest<EL,HE,uint32_t>(s->mem, ea);
   switch(ma & 3)
     {
     case 0:
@@ -1329,33 +1338,27 @@ static void _c(uint32_t inst, state_t *s) {
     }
 }
 
-template <bool appendIns, bool EL>
-void execMips(state_t *s) {
-  uint8_t *mem = s->mem;
-  uint32_t inst = bswap<EL>(*reinterpret_cast<uint32_t*>(mem + s->pc));
-  
-  if(appendIns) globals::cBB->addIns(inst, s->pc);
-  s->icnt++;
-
+template <bool appendIns, bool EL, bool HE>
+void execInsn(uint32_t inst, state_t *s) {
   switch(getInsnType(inst))
     {
     case mips_type::rtype:
-      execRType<appendIns,EL>(inst,s);
+      execRType<appendIns,EL,HE>(inst,s);
       break;
     case mips_type::itype:
-      execIType<appendIns,EL>(inst,s);
+      execIType<appendIns,EL,HE>(inst,s);
       break;
     case mips_type::jtype:
-      execJType<appendIns,EL>(inst,s);
+      execJType<appendIns,EL,HE>(inst,s);
       break;
     case mips_type::cp0:
       execCoproc0<appendIns>(inst,s);
       break;
     case mips_type::cp1:
-      execCoproc1<appendIns,EL>(inst,s);
+      execCoproc1<appendIns,EL,HE>(inst,s);
       break;
     case mips_type::cp1x:
-      execCoproc1x<appendIns,EL>(inst,s);
+      execCoproc1x<appendIns,EL,HE>(inst,s);
       break;
     case mips_type::cp2:
       UNREACHABLE();
@@ -1368,14 +1371,25 @@ void execMips(state_t *s) {
       break;
     case mips_type::ll:
       /* use lw as a proxy */
-      exec_itype<itypeOperation::_lw, EL>(inst,s);
+      exec_itype<itypeOperation::_lw, EL, HE>(inst,s);
       break;
     case mips_type::sc:
-      _sc<EL>(inst, s);
+      _sc<EL,HE>(inst, s);
       break;
     default:
       UNREACHABLE();
     }
+}
+
+template <bool appendIns, bool EL, bool HE>
+void execMips(state_t *s) {
+  uint8_t *mem = s->mem;
+  uint32_t inst = loadGuest<EL,HE,uint32_t>(mem, s->pc);
+  
+  if(appendIns) globals::cBB->addIns(inst, s->pc);
+  s->icnt++;
+
+  execInsn<appendIns,EL,HE>(inst, s);
 
   if(s->gpr[0] != 0) {
     printf("pc=%x, s->gpr[0] = %x\n", s->pc, s->gpr[0]);
@@ -1384,17 +1398,446 @@ void execMips(state_t *s) {
 }
 
 void interpretAndBuildCFG(state_t *s) {
-  execMips<true,false>(s);
+  execMips<true,false,false>(s);
 }
 
 void interpret(state_t *s) {
-  execMips<false,false>(s);
+  execMips<false,false,false>(s);
 }
 
 void interpretAndBuildCFGEL(state_t *s) {
-  execMips<true,true>(s);
+  execMips<true,true,false>(s);
 }
 
 void interpretEL(state_t *s) {
-  execMips<false,true>(s);
+  execMips<false,true,false>(s);
+}
+
+void interpretAndBuildCFGHE(state_t *s) {
+  execMips<true,false,true>(s);
+}
+
+void interpretHE(state_t *s) {
+  execMips<false,false,true>(s);
+}
+
+/* pre-decoded interpreter for read-only basic blocks :
+ * operand fields and handler are resolved once in predecode(),
+ * so the hot path never refetches, byteswaps, or walks
+ * the decode switches above. anything uncommon falls back
+ * to execInsn() on the saved instruction word */
+
+template <bool EL, bool HE>
+static void pdGeneric(const predecodedInsn *d, state_t *s) {
+  execInsn<false,EL,HE>(d->inst, s);
+}
+
+static inline void pdDelaySlot(const predecodedInsn *d, state_t *s) {
+  s->icnt++;
+  d[1].handler(d+1, s);
+}
+
+template <itypeOperation op>
+static void pdIType(const predecodedInsn *d, state_t *s) {
+  int32_t rs = s->gpr[d->rs];
+  switch(op)
+    {
+    case itypeOperation::_addiu:
+      s->gpr[d->rt] = rs + d->imm;
+      break;
+    case itypeOperation::_andi:
+      s->gpr[d->rt] = rs & d->imm;
+      break;
+    case itypeOperation::_ori:
+      s->gpr[d->rt] = rs | d->imm;
+      break;
+    case itypeOperation::_xori:
+      s->gpr[d->rt] = rs ^ d->imm;
+      break;
+    case itypeOperation::_lui:
+      s->gpr[d->rt] = d->imm;
+      break;
+    case itypeOperation::_slti:
+      s->gpr[d->rt] = rs < d->imm;
+      break;
+    case itypeOperation::_sltiu:
+      s->gpr[d->rt] = static_cast<uint32_t>(rs) < static_cast<uint32_t>(d->imm);
+      break;
+    default:
+      UNREACHABLE();
+    }
+  s->pc += 4;
+}
+
+template <bool EL, bool HE, typename T>
+static void pdLoad(const predecodedInsn *d, state_t *s) {
+  uint32_t ea = static_cast<uint32_t>(s->gpr[d->rs]) + d->imm;
+  s->gpr[d->rt] = static_cast<int32_t>(loadGuest<EL,HE,T>(s->mem, ea));
+  s->pc += 4;
+}
+
+template <bool EL, bool HE, typename T>
+static void pdStore(const predecodedInsn *d, state_t *s) {
+  uint32_t ea = static_cast<uint32_t>(s->gpr[d->rs]) + d->imm;
+  storeGuest<EL,HE,T>(s->mem, ea, static_cast<T>(s->gpr[d->rt]));
+  s->pc += 4;
+}
+
+template <rtypeOperation op>
+static void pdRType(const predecodedInsn *d, state_t *s) {
+  int32_t rs = s->gpr[d->rs], rt = s->gpr[d->rt];
+  uint32_t u_rs = static_cast<uint32_t>(rs), u_rt = static_cast<uint32_t>(rt);
+  switch(op)
+    {
+    case rtypeOperation::_sll:
+      s->gpr[d->rd] = u_rt << d->sa;
+      break;
+    case rtypeOperation::_srl:
+      s->gpr[d->rd] = u_rt >> d->sa;
+      break;
+    case rtypeOperation::_sra:
+      s->gpr[d->rd] = rt >> d->sa;
+      break;
+    case rtypeOperation::_sllv:
+      s->gpr[d->rd] = u_rt << (rs & 0x1f);
+      break;
+    case rtypeOperation::_srlv:
+      s->gpr[d->rd] = u_rt >> (rs & 0x1f);
+      break;
+    case rtypeOperation::_srav:
+      s->gpr[d->rd] = rt >> (rs & 0x1f);
+      break;
+    case rtypeOperation::_mfhi:
+      s->gpr[d->rd] = s->hi;
+      break;
+    case rtypeOperation::_mthi:
+      s->hi = rs;
+      break;
+    case rtypeOperation::_mflo:
+      s->gpr[d->rd] = s->lo;
+      break;
+    case rtypeOperation::_mtlo:
+      s->lo = rs;
+      break;
+    case rtypeOperation::_mult: {
+      int64_t y = static_cast<int64_t>(rs) * static_cast<int64_t>(rt);
+      s->lo = static_cast<int32_t>(y & 0xffffffff);
+      s->hi = static_cast<int32_t>(y >> 32);
+      break;
+    }
+    case rtypeOperation::_multu: {
+      uint64_t y = static_cast<uint64_t>(u_rs) * static_cast<uint64_t>(u_rt);
+      s->lo = static_cast<int32_t>(static_cast<uint32_t>(y));
+      s->hi = static_cast<int32_t>(static_cast<uint32_t>(y>>32));
+      break;
+    }
+    case rtypeOperation::_div:
+      if(rt != 0) {
+	s->lo = rs / rt;
+	s->hi = rs % rt;
+      }
+      break;
+    case rtypeOperation::_divu:
+      if(u_rt != 0) {
+	s->lo = u_rs / u_rt;
+	s->hi = u_rs % u_rt;
+      }
+      break;
+    case rtypeOperation::_addu:
+      s->gpr[d->rd] = u_rs + u_rt;
+      break;
+    case rtypeOperation::_subu:
+      s->gpr[d->rd] = u_rs - u_rt;
+      break;
+    case rtypeOperation::_and:
+      s->gpr[d->rd] = rs & rt;
+      break;
+    case rtypeOperation::_or:
+      s->gpr[d->rd] = rs | rt;
+      break;
+    case rtypeOperation::_xor:
+      s->gpr[d->rd] = rs ^ rt;
+      break;
+    case rtypeOperation::_nor:
+      s->gpr[d->rd] = ~(rs | rt);
+      break;
+    case rtypeOperation::_slt:
+      s->gpr[d->rd] = rs < rt;
+      break;
+    case rtypeOperation::_sltu:
+      s->gpr[d->rd] = u_rs < u_rt;
+      break;
+    case rtypeOperation::_movn:
+      if(rt != 0)
+	s->gpr[d->rd] = rs;
+      break;
+    case rtypeOperation::_movz:
+      if(rt == 0)
+	s->gpr[d->rd] = rs;
+      break;
+    default:
+      UNREACHABLE();
+    }
+  s->pc += 4;
+}
+
+static void pdMul(const predecodedInsn *d, state_t *s) {
+  int64_t y = static_cast<int64_t>(s->gpr[d->rs]) * static_cast<int64_t>(s->gpr[d->rt]);
+  s->gpr[d->rd] = static_cast<int32_t>(y);
+  s->pc += 4;
+}
+
+template <branchOperation op, bool likely>
+static void pdBranch(const predecodedInsn *d, state_t *s) {
+  bool takeBranch = false;
+  switch(op)
+    {
+    case branchOperation::_beq:
+      takeBranch = (s->gpr[d->rt] == s->gpr[d->rs]);
+      break;
+    case branchOperation::_bne:
+      takeBranch = (s->gpr[d->rt] != s->gpr[d->rs]);
+      break;
+    case branchOperation::_bgtz:
+      takeBranch = (s->gpr[d->rs] > 0);
+      break;
+    case branchOperation::_blez:
+      takeBranch = (s->gpr[d->rs] <= 0);
+      break;
+    case branchOperation::_bgez:
+      takeBranch = (s->gpr[d->rs] >= 0);
+      break;
+    case branchOperation::_bltz:
+      takeBranch = (s->gpr[d->rs] < 0);
+      break;
+    default:
+      UNREACHABLE();
+    }
+  uint32_t npc = s->pc + 4 + d->imm;
+  s->pc += 4;
+  if(likely) {
+    if(takeBranch) {
+      pdDelaySlot(d, s);
+      s->pc = npc;
+    }
+    else {
+      s->pc += 4;
+    }
+  }
+  else {
+    pdDelaySlot(d, s);
+    if(takeBranch)
+      s->pc = npc;
+  }
+  getNextBlock(s);
+}
+
+template <jumpOperation op>
+static void pdJump(const predecodedInsn *d, state_t *s) {
+  if(op == jumpOperation::_jal) {
+    s->gpr[R_ra] = s->pc+8;
+  }
+  s->pc += 4;
+  pdDelaySlot(d, s);
+  s->pc = static_cast<uint32_t>(d->imm);
+  getNextBlock(s);
+}
+
+template <bool link>
+static void pdJr(const predecodedInsn *d, state_t *s) {
+  uint32_t jaddr = s->gpr[d->rs];
+  if(link) {
+    s->gpr[31] = s->pc+8;
+  }
+  s->pc += 4;
+  pdDelaySlot(d, s);
+  s->pc = jaddr;
+  getNextBlock(s);
+}
+
+template <bool EL, bool HE>
+static bool predecodeInsn(uint32_t inst, uint32_t addr, bool hasDelaySlot, predecodedInsn &pi) {
+  mips_t mi(inst);
+  int32_t simm = signExtendImm(mi.i);
+  int32_t uimm = static_cast<int32_t>(inst & ((1<<16) - 1));
+  pi.handler = pdGeneric<EL,HE>;
+  pi.inst = inst;
+  pi.imm = 0;
+  pi.rs = mi.r.rs;
+  pi.rt = mi.r.rt;
+  pi.rd = mi.r.rd;
+  pi.sa = mi.r.sa;
+
+  /* branches and jumps need their delay slot decoded
+   * directly after them */
+  if(isBranchOrJump(inst) and not(hasDelaySlot)) {
+    return true;
+  }
+  
+  switch(getInsnType(inst))
+    {
+    case mips_type::rtype:
+      switch(mi.r.opcode)
+	{
+#define PD_RTYPE(f, op) case f: pi.handler = pdRType<rtypeOperation::op>; break;
+	  PD_RTYPE(0x00, _sll)
+	  PD_RTYPE(0x02, _srl)
+	  PD_RTYPE(0x03, _sra)
+	  PD_RTYPE(0x04, _sllv)
+	  PD_RTYPE(0x06, _srlv)
+	  PD_RTYPE(0x07, _srav)
+	  PD_RTYPE(0x10, _mfhi)
+	  PD_RTYPE(0x11, _mthi)
+	  PD_RTYPE(0x12, _mflo)
+	  PD_RTYPE(0x13, _mtlo)
+	  PD_RTYPE(0x18, _mult)
+	  PD_RTYPE(0x19, _multu)
+	  PD_RTYPE(0x1A, _div)
+	  PD_RTYPE(0x1B, _divu)
+	  PD_RTYPE(0x20, _addu)
+	  PD_RTYPE(0x21, _addu)
+	  PD_RTYPE(0x23, _subu)
+	  PD_RTYPE(0x24, _and)
+	  PD_RTYPE(0x25, _or)
+	  PD_RTYPE(0x26, _xor)
+	  PD_RTYPE(0x27, _nor)
+	  PD_RTYPE(0x2A, _slt)
+	  PD_RTYPE(0x2B, _sltu)
+	  PD_RTYPE(0x0A, _movz)
+	  PD_RTYPE(0x0B, _movn)
+#undef PD_RTYPE
+	case 0x08:
+	  pi.handler = pdJr<false>;
+	  break;
+	case 0x09:
+	  pi.handler = pdJr<true>;
+	  break;
+	case 0x0f:
+	  /* sync throws away every block, including this one */
+	  return false;
+	default:
+	  break;
+	}
+      break;
+    case mips_type::jtype:
+      pi.imm = static_cast<int32_t>(((inst & ((1<<26)-1)) << 2) | ((addr + 4) & (~((1<<28)-1))));
+      pi.handler = (inst>>26)==0x2 ? pdJump<jumpOperation::_j> : pdJump<jumpOperation::_jal>;
+      break;
+    case mips_type::itype:
+      pi.imm = simm;
+      switch(mi.i.opcode)
+	{
+	case 0x01:
+	  pi.imm = simm << 2;
+	  switch(mi.i.rt)
+	    {
+	    case 0:
+	      pi.handler = pdBranch<branchOperation::_bltz,false>;
+	      break;
+	    case 1:
+	      pi.handler = pdBranch<branchOperation::_bgez,false>;
+	      break;
+	    case 2:
+	      pi.handler = pdBranch<branchOperation::_bltz,true>;
+	      break;
+	    case 3:
+	      pi.handler = pdBranch<branchOperation::_bgez,true>;
+	      break;
+	    default:
+	      break;
+	    }
+	  break;
+#define PD_BRANCH(o, op, l) case o: pi.imm = simm << 2; pi.handler = pdBranch<branchOperation::op,l>; break;
+	  PD_BRANCH(0x04, _beq, false)
+	  PD_BRANCH(0x05, _bne, false)
+	  PD_BRANCH(0x06, _blez, false)
+	  PD_BRANCH(0x07, _bgtz, false)
+	  PD_BRANCH(0x14, _beq, true)
+	  PD_BRANCH(0x15, _bne, true)
+	  PD_BRANCH(0x16, _blez, true)
+	  PD_BRANCH(0x17, _bgtz, true)
+#undef PD_BRANCH
+	case 0x08:
+	case 0x09:
+	  pi.handler = pdIType<itypeOperation::_addiu>;
+	  break;
+	case 0x0a:
+	  pi.handler = pdIType<itypeOperation::_slti>;
+	  break;
+	case 0x0b:
+	  pi.handler = pdIType<itypeOperation::_sltiu>;
+	  break;
+	case 0x0c:
+	  pi.imm = uimm;
+	  pi.handler = pdIType<itypeOperation::_andi>;
+	  break;
+	case 0x0d:
+	  pi.imm = uimm;
+	  pi.handler = pdIType<itypeOperation::_ori>;
+	  break;
+	case 0x0e:
+	  pi.imm = uimm;
+	  pi.handler = pdIType<itypeOperation::_xori>;
+	  break;
+	case 0x0f:
+	  pi.imm = static_cast<int32_t>(static_cast<uint32_t>(uimm) << 16);
+	  pi.handler = pdIType<itypeOperation::_lui>;
+	  break;
+	case 0x20:
+	  pi.handler = pdLoad<EL,HE,int8_t>;
+	  break;
+	case 0x21:
+	  pi.handler = pdLoad<EL,HE,int16_t>;
+	  break;
+	case 0x23:
+	  pi.handler = pdLoad<EL,HE,int32_t>;
+	  break;
+	case 0x24:
+	  pi.handler = pdLoad<EL,HE,uint8_t>;
+	  break;
+	case 0x25:
+	  pi.handler = pdLoad<EL,HE,uint16_t>;
+	  break;
+	case 0x28:
+	  pi.handler = pdStore<EL,HE,int8_t>;
+	  break;
+	case 0x29:
+	  pi.handler = pdStore<EL,HE,int16_t>;
+	  break;
+	case 0x2b:
+	  pi.handler = pdStore<EL,HE,int32_t>;
+	  break;
+	default:
+	  break;
+	}
+      break;
+    case mips_type::special2:
+      if((inst & 63) == 0x2) {
+	pi.handler = pdMul;
+      }
+      break;
+    default:
+      break;
+    }
+  return true;
+}
+
+bool predecode(uint32_t inst, uint32_t addr, bool hasDelaySlot, predecodedInsn &pi) {
+  if(globals::isMipsEL)
+    return predecodeInsn<true,false>(inst, addr, hasDelaySlot, pi);
+  else if(globals::hostEndianMem)
+    return predecodeInsn<false,true>(inst, addr, hasDelaySlot, pi);
+  else
+    return predecodeInsn<false,false>(inst, addr, hasDelaySlot, pi);
+}
+
+void interpretPredecoded(const predecodedInsn *code, size_t n, state_t *s) {
+  for(size_t i = 0; (i < n) && (s->brk == 0); i++) {
+    s->icnt++;
+    code[i].handler(code + i, s);
+  }
+  if(s->gpr[0] != 0) {
+    printf("pc=%x, s->gpr[0] = %x\n", s->pc, s->gpr[0]);
+    exit(-1);
+  }
 }
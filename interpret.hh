@@ -2,12 +2,31 @@
 #define __INTERPRET_HH__
 
 #include <cstdint>
+#include <cstddef>
 struct state_t;
+struct predecodedInsn;
+
+typedef void (*predecodedHandler)(const predecodedInsn *, state_t *);
+
+/* decoded form of an instruction in a read-only basic block,
+ * operand fields are extracted once so the interpreter can
+ * dispatch straight to the handler */
+struct predecodedInsn {
+  predecodedHandler handler;
+  uint32_t inst;
+  int32_t imm;
+  uint8_t rs, rt, rd, sa;
+};
 
 void interpretAndBuildCFG(state_t *s);
 void interpret(state_t *s);
 void interpretAndBuildCFGEL(state_t *s);
 void interpretEL(state_t *s);
+/* big-endian guest with host order words in memory */
+void interpretAndBuildCFGHE(state_t *s);
+void interpretHE(state_t *s);
 void mkMonitorVectors(state_t *s);
+bool predecode(uint32_t inst, uint32_t addr, bool hasDelaySlot, predecodedInsn &pi);
+void interpretPredecoded(const predecodedInsn *code, size_t n, state_t *s);
 
 #endif
@@ -2,6 +2,7 @@
 #define __SIM_LLVM_HH__
 
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 #include "llvm/IR/AssemblyAnnotationWriter.h"
@@ -10,6 +11,13 @@
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/Interpreter.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -31,9 +39,12 @@
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/Host.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 
 #define MakeGEP(PTR, IDX) CreateGEP((PTR)->getType()->getPointerElementType(), (PTR), (IDX))
 #define MakeLoad(PTR, NAME) CreateLoad((PTR)->getType()->getPointerElementType(), (PTR), (NAME))
@@ -24,6 +24,7 @@
 #include "helper.hh"
 #define ELIDE_LLVM
 #include "globals.hh"
+#include "guestMem.hh"
 
 
 static const void* FAILED_MMAP = reinterpret_cast<void*>(-1);
@@ -73,9 +74,12 @@ bool load_elf(const char* fn, uint32_t &entry_p,  std::map<uint32_t, std::pair<s
     return false;
   }
   buf = reinterpret_cast<uint8_t*>(mm);
+  globals::elfHash = crc32(buf, s.st_size);
   /* Check for a MIPS machine */
   if(eh32->e_ident[EI_DATA] == ELFDATA2LSB) {
     globals::isMipsEL = true;
+    /* little-endian guests already match the host */
+    globals::hostEndianMem = false;
   }
   else if(eh32->e_ident[EI_DATA] == ELFDATA2MSB) {
     globals::isMipsEL = false;
@@ -110,8 +114,8 @@ bool load_elf(const char* fn, uint32_t &entry_p,  std::map<uint32_t, std::pair<s
 	lAddr = (p_vaddr + p_memsz);
       }
       memset(mem+p_vaddr, 0, sizeof(uint8_t)*p_memsz);
-      memcpy(mem+p_vaddr, reinterpret_cast<uint8_t*>(buf + p_offset),
-	     sizeof(uint8_t)*p_filesz);
+      copyToGuest(mem, p_vaddr, reinterpret_cast<uint8_t*>(buf + p_offset),
+		  sizeof(uint8_t)*p_filesz);
     }
   }
   Elf32_Sym *SymTbl = nullptr;
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <cassert>
 #include <fstream>
+#include <vector>
 #include <boost/program_options.hpp>
 
 #include <unistd.h>
@@ -24,6 +25,8 @@
 #include "globals.hh"
 #include "simPoints.hh"
 #include "saveState.hh"
+#include "guestMem.hh"
+#include "codeHeap.hh"
 
 extern const char* githash;
 int sArgc = -1;
@@ -33,6 +36,7 @@ namespace globals {
   int sArgc = 0;
   char** sArgv = nullptr;
   bool isMipsEL = false;
+  bool hostEndianMem = false;
   llvm::CodeGenOpt::Level regionOptLevel = llvm::CodeGenOpt::Aggressive;
   bool countInsns = true;
   bool simPoints = false;
@@ -49,7 +53,14 @@ namespace globals {
   bool fuseCFGs = true;
   bool enableBoth = true;
   uint32_t enoughRegions = 5;
+  uint64_t blockJitThresh = 2048;
+  uint64_t tierUpIcnt = 1UL<<24;
+  double reformShare = 0.25;
+  bool chainRegions = true;
+  uint32_t compileThreads = 2;
+  uint32_t elfHash = 0;
   bool dumpIR = false;
+  bool report = false;
   bool splitCFGBBs = true;
   uint64_t nFuses = 0;
   uint64_t nAttemptedFuses = 0;
@@ -60,15 +71,36 @@ namespace globals {
   std::set<int> openFileDes;
   bool profile = false;
   uint64_t dumpicnt = ~(0UL);
+  std::string irPasses;
+  std::string jitCPU;
+  std::string jitFeatures;
 }
 
 perfmap* perfmap::theInstance = nullptr;
 std::set<regionCFG*> regionCFG::regionCFGs;
+uint8_t *regionCFG::guestMem = nullptr;
+transCache *regionCFG::objCache = nullptr;
+std::unique_ptr<llvm::orc::LLJIT> regionCFG::jit;
 uint64_t regionCFG::icnt = 0;
 uint64_t regionCFG::iters = 0;
-std::map<uint32_t, basicBlock*> basicBlock::bbMap;
-std::map<uint32_t, basicBlock*> basicBlock::insMap;
-std::map<uint32_t, uint64_t> basicBlock::insInBBCnt;
+uint64_t regionCFG::blockIcnt = 0;
+uint64_t regionCFG::blockIters = 0;
+uint64_t regionCFG::nBlockCompiles = 0;
+uint64_t regionCFG::nTierUps = 0;
+uint64_t regionCFG::nDispatches = 0;
+uint64_t regionCFG::nReforms = 0;
+std::unordered_map<uint32_t, regionCFG*> regionCFG::entryPoints;
+std::unordered_multimap<uint32_t, regionExit*> regionCFG::exitsByPC;
+uint64_t regionCFG::nChainedExits = 0;
+std::array<regionExit, regionCFG::ibtcLen> regionCFG::ibtc;
+std::set<regionExit*> regionCFG::indirectSites;
+std::array<regionCFG::rasEntry, regionCFG::rasLen> regionCFG::ras;
+uint32_t regionCFG::rasTop = 0;
+regionExit regionCFG::nativeReturn;
+uint32_t regionCFG::callDepth = 0;
+pcTable<basicBlock*> basicBlock::bbMap;
+pcTable<basicBlock*> basicBlock::insMap;
+pcTable<uint64_t> basicBlock::insInBBCnt;
 
 
 #if ((LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR > 8) || (LLVM_VERSION_MAJOR > 3))
@@ -82,6 +114,17 @@ static llvm::CodeGenOpt::Level optLevels[4] = {llvm::CodeGenOpt::None,
 					       llvm::CodeGenOpt::Default,
 					       llvm::CodeGenOpt::Aggressive};
 
+/* new pass manager pipelines run on regions before codegen */
+static const char *irPresets[4] = {
+  "",
+  "function(sroa,early-cse,instcombine,simplifycfg)",
+  "function(sroa,early-cse<memssa>,instcombine,simplifycfg,reassociate,"
+  "gvn,sccp,dse,adce,simplifycfg,instcombine)",
+  "function(sroa,early-cse<memssa>,instcombine,simplifycfg,reassociate,"
+  "loop-mssa(loop-rotate,licm),gvn,sccp,loop-unroll<O3>,instcombine,"
+  "dse,adce,simplifycfg)"
+};
+
 static cfgAugEnum augLevels[4] = {cfgAugEnum::none,
 				  cfgAugEnum::head,
 				  cfgAugEnum::aggressive,
@@ -144,11 +187,13 @@ int main(int argc, char *argv[]) {
   uint8_t *mem = nullptr;
   uint32_t entry_p = 0;
 
-  uint32_t optidx = 3, augidx = 1;
+  uint32_t optidx = 3, augidx = 1, iroptidx = 3, codeHeapMB = 256;
   double estart=0,estop=0;
-  bool report=false, hash=false, fp_exception=false, replay = false, isdump = false;
+  bool hash=false, fp_exception=false, replay = false, isdump = false, aot = false;
+  bool hugeCode = false;
   uint64_t max_icnt = 0;
-  std::string sysArgs, filename, simPointsFname;
+  std::string sysArgs, filename, simPointsFname, transCacheDir;
+  std::string loadProfileName, saveProfileName;
   po::options_description desc("Options");
   po::variables_map vm;
   desc.add_options() 
@@ -162,13 +207,29 @@ int main(int argc, char *argv[]) {
    ("enoughRegions,e", po::value<uint32_t>(&globals::enoughRegions)->default_value(5), "how many times does each region need to get executed")    
    ("file,f", po::value<std::string>(&filename), "mips binary")
    ("hash,h", po::value<bool>(&hash)->default_value(false), "hash memory at end of execution")
+   ("hostEndian", po::value<bool>(&globals::hostEndianMem)->default_value(false), "keep big-endian guest memory as host order words")
    ("ipo,i", po::value<bool>(&globals::ipo)->default_value(true), "allow jr,jal,jalr in regions")
    ("lines,l", po::value<size_t>(&cl)->default_value(8), "region-cache lines")
    ("opt,o", po::value<uint32_t>(&optidx)->default_value(3), "how much llvm code optimization")
+   ("irOpt", po::value<uint32_t>(&iroptidx)->default_value(3), "llvm ir passes on regions (0=none,1=local,2=scalar,3=loops)")
+   ("irPasses", po::value<std::string>(&globals::irPasses), "llvm ir pass pipeline, overrides irOpt")
+   ("jitCPU", po::value<std::string>(&globals::jitCPU)->default_value("host"), "cpu regions are compiled for (host, generic or an llvm cpu name)")
+   ("jitFeatures", po::value<std::string>(&globals::jitFeatures), "comma separated target features added to jitCPU's, e.g. -avx512f")
    ("replay", po::value<bool>(&replay)->default_value(false), "replay binary")
-   ("report,r", po::value<bool>(&report)->default_value(false), "report stats at end of execution")
+   ("report,r", po::value<bool>(&globals::report)->default_value(false), "report stats at end of execution")
    ("profile,p", po::value<bool>(&globals::profile)->default_value(false), "report execution profile")
    ("hotThresh,t", po::value<size_t>(&hotThresh)->default_value(500), "hot bb threshold")    
+   ("blockJit", po::value<uint64_t>(&globals::blockJitThresh)->default_value(2048), "executions before a basicblock is compiled on its own (0 disables)")
+   ("tierUp", po::value<uint64_t>(&globals::tierUpIcnt)->default_value(1UL<<24), "instructions a region runs unoptimized before it's recompiled at --opt (0 compiles at --opt right away)")
+   ("reformExit", po::value<double>(&globals::reformShare)->default_value(0.25), "share of a region's entries leaving by one exit before the region is rebuilt to include the exit's path (0 disables)")
+   ("chain", po::value<bool>(&globals::chainRegions)->default_value(true), "exits from compiled code jump directly to other compiled code")
+   ("compileThreads", po::value<uint32_t>(&globals::compileThreads)->default_value(2), "background threads generating region machine code (0 compiles inline)")
+   ("codeHeap", po::value<uint32_t>(&codeHeapMB)->default_value(256), "MB of huge page backed jit code (0 maps each region on its own)")
+   ("hugeCode", po::value<bool>(&hugeCode)->default_value(false), "back the code heap with hugetlbfs pages rather than transparent huge pages")
+   ("transCache", po::value<std::string>(&transCacheDir), "directory of compiled regions reused across runs")
+   ("loadProfile", po::value<std::string>(&loadProfileName), "compile the regions of a saved profile at startup")
+   ("saveProfile", po::value<std::string>(&saveProfileName), "save blocks, edges and regions at exit")
+   ("aot", po::value<bool>(&aot)->default_value(false), "translate functions from the symbol table at startup")
    ("verbose,v", po::value<bool>(&globals::verbose)->default_value(false), "print debug information")
    ("fp_exception", po::value<bool>(&fp_exception)->default_value(false), "fp exception")
    ("aug", po::value<uint32_t>(&augidx)->default_value(1), "how much cfg augmentation")
@@ -197,6 +258,28 @@ int main(int argc, char *argv[]) {
   
   globals::regionOptLevel = optLevels[optidx&3];
   globals::cfgAug = augLevels[augidx&3];
+  if(globals::irPasses.empty()) {
+    globals::irPasses = irPresets[iroptidx&3];
+  }
+  else {
+    std::string err = regionCFG::checkPasses(globals::irPasses);
+    if(not(err.empty())) {
+      std::cerr << KRED << "command-line error : " << err << KNRM << "\n";
+      return -1;
+    }
+  }
+  if(globals::enableCFG) {
+    std::string err = regionCFG::checkTarget();
+    if(not(err.empty())) {
+      std::cerr << KRED << "command-line error : " << err << KNRM << "\n";
+      return -1;
+    }
+  }
+  /* chained code only returns to the dispatcher
+   * through unlinked exits */
+  if(vm.count("dumpicnt")) {
+    globals::chainRegions = false;
+  }
   
   if(globals::simPoints) {
     globals::countInsns = true;
@@ -253,11 +336,33 @@ int main(int argc, char *argv[]) {
     }
   }
   globals::regionFinder = new region(cl, hotThresh);
-  globals::cBB = new basicBlock(entry_p);
   s->pc = entry_p;
   mkMonitorVectors(s);
   initCapstone();
   
+  if(globals::enableCFG and not(transCacheDir.empty())) {
+    regionCFG::objCache = new transCache(transCacheDir, globals::elfHash, globals::irPasses,
+					  regionCFG::hostTarget());
+  }
+  if(globals::enableCFG) {
+    regionCFG::guestMem = s->mem;
+    if(codeHeapMB and not(codeHeap::init(static_cast<size_t>(codeHeapMB)<<20, hugeCode))) {
+      std::cerr << globals::binaryName << ": couldn't map the code heap, "
+		<< "regions get their own mappings\n";
+    }
+    regionCFG::startJIT();
+    regionCFG::startCompileThreads(globals::compileThreads);
+    if(not(loadProfileName.empty())) {
+      basicBlock::loadProfile(loadProfileName);
+    }
+    if(aot) {
+      basicBlock::translateStatic(syms, s->mem);
+    }
+  }
+  globals::cBB = basicBlock::globalFindBlock(entry_p);
+  if(globals::cBB == nullptr) {
+    globals::cBB = new basicBlock(entry_p);
+  }
   estart = timestamp();
   if(setjmp(jenv) > 0) {
     std::cerr << globals::binaryName << ": returning from longjmp\n";
@@ -269,6 +374,11 @@ int main(int argc, char *argv[]) {
 	interpretEL(s);
       }
     }
+    else if(globals::hostEndianMem) {
+      while(s->brk==0 and s->icnt < max_icnt) {
+	interpretHE(s);
+      }
+    }
     else {
       while(s->brk==0 and s->icnt < max_icnt) {
 	interpret(s);
@@ -282,6 +392,12 @@ int main(int argc, char *argv[]) {
 	  interpretAndBuildCFGEL(s);
       }
     }
+    else if(globals::hostEndianMem) {
+      while(s->brk==0) {
+	if(not(globals::cBB->executeJIT(s)))
+	  interpretAndBuildCFGHE(s);
+      }
+    }
     else {
       while(s->brk==0) {
 	if(not(globals::cBB->executeJIT(s)))
@@ -290,15 +406,16 @@ int main(int argc, char *argv[]) {
     }
   }
   estop = timestamp();
+  regionCFG::stopCompileThreads();
   double runtime = (estop-estart);
   struct rusage usage;
   uint64_t dupIns = 0;
   getrusage(RUSAGE_SELF,&usage);  
-  for(auto &p : basicBlock::insInBBCnt) {
-    if(p.second > 1) {
-      dupIns++;
-    }
-  }
+  basicBlock::insInBBCnt.forEach([&dupIns](uint32_t pc, uint64_t cnt) {
+      if(cnt > 1) {
+	dupIns++;
+      }
+    });
   
   std::cerr << KGRN << globals::binaryName << " statistics\n"
 	    << "\t"
@@ -310,15 +427,36 @@ int main(int argc, char *argv[]) {
 	    << " megains/sec" << "\n"
 	    << "\t" << 100.0*(static_cast<double>(regionCFG::icnt)/s->icnt)
 	    << "% of instructions executed in CFG JIT\n"
-	    << "\t" << 100.0*(static_cast<double>(s->icnt - regionCFG::icnt)/s->icnt)
+	    << "\t" << 100.0*(static_cast<double>(regionCFG::blockIcnt)/s->icnt)
+	    << "% of instructions executed in block JIT\n"
+	    << "\t" << 100.0*(static_cast<double>(s->icnt - regionCFG::icnt - regionCFG::blockIcnt)/s->icnt)
 	    << "% of instructions executed in the interpreter\n"
 	    << "\t"
 	    << "regionCFGs size="
 	    << regionCFG::regionCFGs.size()
 	    << ", compile called = "
 	    << globals::nCfgCompiles
+	    << " times, "
+	    << regionCFG::nTierUps
+	    << " regions recompiled optimized, "
+	    << regionCFG::nReforms
+	    << " rebuilt around hot exits\n"
+	    << "\t"
+	    << "block compiles = "
+	    << regionCFG::nBlockCompiles
+	    << ", block code invoked = "
+	    << regionCFG::blockIters
 	    << " times\n"
 	    << "\t"
+	    << regionCFG::nChainedExits
+	    << " exits chained to compiled code\n"
+	    << "\t"
+	    << transCache::hits << " compiles loaded from the translation cache, "
+	    << transCache::misses << " missed\n"
+	    << "\t"
+	    << (codeHeap::inUse() >> 10) << " KB of code heap in use, "
+	    << (codeHeap::peakUse() >> 10) << " KB peak\n"
+	    << "\t"
 	    << basicBlock::numBBs() << " basic blocks, "
 	    << basicBlock::numStaticInsns() << " static instructions, "
 	    << dupIns << " duplicated instructions\n"
@@ -335,15 +473,15 @@ int main(int argc, char *argv[]) {
   }
 
   
-  if(report) {
+  if(globals::report) {
     debugSymDB::init(filename.c_str());
     std::vector<execUnit*> eUnitVec;
     for(auto tbb : regionCFG::regionCFGs) {
       eUnitVec.push_back(tbb);
     }
-    for(auto p : basicBlock::bbMap) {
-      eUnitVec.push_back(p.second);
-    }
+    basicBlock::bbMap.forEach([&eUnitVec](uint32_t pc, basicBlock *bb) {
+	eUnitVec.push_back(bb);
+      });
     std::sort(eUnitVec.begin(), eUnitVec.end(), execUnit::execUnitSorter());
     
     std::string reportStr;
@@ -362,9 +500,9 @@ int main(int argc, char *argv[]) {
   if(globals::profile) {
     debugSymDB::init(filename.c_str());
     std::vector<execUnit*> eUnitVec;
-    for(auto p : basicBlock::bbMap) {
-      eUnitVec.push_back(p.second);
-    }
+    basicBlock::bbMap.forEach([&eUnitVec](uint32_t pc, basicBlock *bb) {
+	eUnitVec.push_back(bb);
+      });
     std::sort(eUnitVec.begin(), eUnitVec.end(), execUnit::execUnitSorter());
     std::string reportStr;
     for(size_t i = 0; i < eUnitVec.size(); i++) {
@@ -379,12 +517,31 @@ int main(int argc, char *argv[]) {
     }    
   }
 
+  if(not(saveProfileName.empty())) {
+    basicBlock::saveProfile(saveProfileName);
+  }
   basicBlock::dropAllBBs();
+  regionCFG::stopJIT();
   delete globals::regionFinder;
+  delete regionCFG::objCache;
   
   if(hash) {
+    uint32_t crc = ~0x0;
+    if(globals::hostEndianMem) {
+      /* hash guest byte order so both layouts agree */
+      static const size_t chunk = 1UL<<16;
+      std::vector<uint8_t> buf(chunk);
+      for(size_t a = 0; a < (1UL<<32); a += chunk) {
+	memcpy(buf.data(), mem + a, chunk);
+	swapGuestWords(buf.data(), chunk);
+	crc = update_crc(crc, buf.data(), chunk);
+      }
+    }
+    else {
+      crc = update_crc(crc, mem, 1LU<<32);
+    }
     std::cerr << "crc32=" << std::hex
-	      << crc32(mem, 1LU<<32)<<std::dec
+	      << (crc ^ (~0x0)) <<std::dec
 	      << "\n";
   }
       
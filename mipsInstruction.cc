@@ -8,19 +8,19 @@
 
 typedef llvm::Value lv_t;
 
-static Insn* getRType(uint32_t inst, uint32_t addr);
-static Insn* getSpecial2(uint32_t inst, uint32_t addr);
-static Insn* getSpecial3(uint32_t inst, uint32_t addr);
-static Insn* getJType(uint32_t inst, uint32_t addr) {
+static Insn* getRType(arena &a, uint32_t inst, uint32_t addr);
+static Insn* getSpecial2(arena &a, uint32_t inst, uint32_t addr);
+static Insn* getSpecial3(arena &a, uint32_t inst, uint32_t addr);
+static Insn* getJType(arena &a, uint32_t inst, uint32_t addr) {
   uint32_t opcode = inst>>26;
   if(opcode==0x2)
-    return new insn_j(inst, addr);
+    return a.make<insn_j>(inst, addr);
   else if(opcode==0x3)
-    return new insn_jal(inst, addr);
+    return a.make<insn_jal>(inst, addr);
   return nullptr;
 }
-static Insn* getCoproc0(uint32_t inst, uint32_t addr);
-static Insn* getCoproc1(uint32_t inst, uint32_t addr);
+static Insn* getCoproc0(arena &a, uint32_t inst, uint32_t addr);
+static Insn* getCoproc1(arena &a, uint32_t inst, uint32_t addr);
 
 #define TC ((fmt==FMT_D?fprUseEnum::doublePrec : fprUseEnum::singlePrec))
 
@@ -334,6 +334,7 @@ private:
 class insn_movn : public rTypeInsn {
 public:
   insn_movn(uint32_t inst, uint32_t addr) : rTypeInsn(inst, addr) {}
+  void recUses(cfgBasicBlock *cBB) override;
   bool generateIR(cfgBasicBlock *cBB, Insn* nInst, llvmRegTables& regTbl) override;
 };
 
@@ -341,6 +342,7 @@ class insn_movz : public rTypeInsn {
 public:
   insn_movz(uint32_t inst, uint32_t addr) :
    rTypeInsn(inst, addr) {}
+  void recUses(cfgBasicBlock *cBB) override;
   bool generateIR(cfgBasicBlock *cBB, Insn* nInst, llvmRegTables& regTbl) override;
 };
 
@@ -1066,7 +1068,7 @@ void coprocType1xInsn::recUses(cfgBasicBlock *cBB) {
     }
 }
 
-static Insn* getCoproc1x(uint32_t inst, uint32_t addr) {
+static Insn* getCoproc1x(arena &a, uint32_t inst, uint32_t addr) {
   mips_t mi(inst);
   switch(mi.lc1x.id)
     {
@@ -1083,9 +1085,9 @@ static Insn* getCoproc1x(uint32_t inst, uint32_t addr) {
   switch(mi.c1x.id)
     {
     case 4:
-      return new fmadd(inst, addr);
+      return a.make<fmadd>(inst, addr);
     case 5:
-      return new fmsub(inst, addr);
+      return a.make<fmsub>(inst, addr);
     default:
       break;
     }
@@ -1120,10 +1122,10 @@ bool fmsub::generateIR(cfgBasicBlock *cBB, Insn* nInst, llvmRegTables& regTbl) {
 #undef TTC
 }
 
-static Insn* getCoproc2(uint32_t inst, uint32_t addr) {
+static Insn* getCoproc2(arena &a, uint32_t inst, uint32_t addr) {
   return nullptr;
 }
-static Insn* getIType(uint32_t inst, uint32_t addr);
+static Insn* getIType(arena &a, uint32_t inst, uint32_t addr);
 
 std::string Insn::getString() const {
   std::stringstream ss;
@@ -1188,11 +1190,34 @@ void Insn::set(regionCFG *cfg, cfgBasicBlock *cBB) {
   this->cfg = cfg;  myBB = cBB;
 }
 
+llvm::Value *Insn::subWordEA(llvm::Value *vEA, uint32_t bytes) {
+  if(globals::isMipsEL or not(globals::hostEndianMem)) {
+    return vEA;
+  }
+  /* bytes and halfwords of a host order word */
+  llvm::Value *vFlip = llvm::ConstantInt::get(vEA->getType(), 4 - bytes);
+  return cfg->myIRBuilder->CreateXor(vEA, vFlip);
+}
+
 llvm::Value *Insn::byteSwap(llvm::Value *v) {
   if(globals::isMipsEL) {
     return v;
   }
+  else if(globals::hostEndianMem) {
+    /* memory already holds host order words, only the halves
+     * of a doubleword are exchanged */
+    if(v->getType()->getIntegerBitWidth() != 64) {
+      return v;
+    }
+    auto vfshlIntr = llvm::Intrinsic::getDeclaration(cfg->myModule,
+						     llvm::Intrinsic::fshl,
+						     v->getType());
+    llvm::Value *v32 = llvm::ConstantInt::get(v->getType(), 32);
+    return cfg->myIRBuilder->CreateCall(vfshlIntr, {v, v, v32});
+  }
   else {
+    /* a bswap next to its load or store is selected as movbe
+     * when the jit target has it (see regionCFG::hostTarget) */
     std::vector<llvm::Type*> typeVec;
     typeVec.push_back(v->getType());
     llvm::ArrayRef<llvm::Type*> typeArrRef(typeVec);
@@ -1242,6 +1267,17 @@ void rTypeInsn::recUses(cfgBasicBlock *cBB) {
   cBB->gprRead[rt]=true;
 }
 
+void insn_movn::recUses(cfgBasicBlock *cBB) {
+  rTypeInsn::recUses(cBB);
+  /* rd keeps its old value when the move is not taken */
+  cBB->gprRead[rd]=true;
+}
+
+void insn_movz::recUses(cfgBasicBlock *cBB) {
+  rTypeInsn::recUses(cBB);
+  cBB->gprRead[rd]=true;
+}
+
 void rTypeInsn::updateGPRConstants(std::vector<regState> &gprConstState) {
   if((gprConstState[rs].e == constant) && (gprConstState[rt].e == constant)) {
     gprConstState[rd].e = constant;
@@ -1364,7 +1400,7 @@ bool iBranchTypeInsn::handleBranch(cfgBasicBlock *cBB, Insn* nInst,
     ntBB = t1;
     llvm::Instruction *TI = cfg->myIRBuilder->CreateCondBr(vCMP, tBB, ntBB);
 #if 1
-    llvm::MDBuilder MDB(globalContext);
+    llvm::MDBuilder MDB(*(cfg->Context));
     llvm::MDNode *Node = nullptr;
     if(tIsAbort)
       Node  = MDB.createBranchWeights(5,95);
@@ -1875,7 +1911,7 @@ bool insn_seh::generateIR(cfgBasicBlock *cBB, Insn* nInst, llvmRegTables& regTbl
   return false;
 }
 
-Insn* getInsn(uint32_t inst, uint32_t addr){
+Insn* getInsn(arena &a, uint32_t inst, uint32_t addr){
   uint32_t opcode = inst>>26;
   bool isRType = (opcode==0);
   bool isJType = ((opcode>>1)==1);
@@ -1890,27 +1926,27 @@ Insn* getInsn(uint32_t inst, uint32_t addr){
   Insn *ins = nullptr;
 
   if(isRType)
-    ins =  getRType(inst, addr);
+    ins =  getRType(a, inst, addr);
   else if(isSpecial2)
-    ins =  getSpecial2(inst, addr);
+    ins =  getSpecial2(a, inst, addr);
   else if(isSpecial3)
-    ins =  getSpecial3(inst, addr);
+    ins =  getSpecial3(a, inst, addr);
   else if(isJType)
-    ins =  getJType(inst, addr);
+    ins =  getJType(a, inst, addr);
   else if(isCoproc0)
-    ins =  getCoproc0(inst, addr);
+    ins =  getCoproc0(a, inst, addr);
   else if(isCoproc1)
-    ins =  getCoproc1(inst, addr);
+    ins =  getCoproc1(a, inst, addr);
   else if(isCoproc1x)
-    ins =  getCoproc1x(inst, addr);
+    ins =  getCoproc1x(a, inst, addr);
   else if(isCoproc2)
-    ins =  getCoproc2(inst, addr);
+    ins =  getCoproc2(a, inst, addr);
   else if(isLoadLinked)
     ins =  nullptr;
   else if(isStoreCond)
     ins = nullptr;
   else 
-    ins =  getIType(inst, addr);
+    ins =  getIType(a, inst, addr);
 
   if(ins == nullptr) {
     printf("returning nullptr for %x:%s!\n",addr,getAsmString(inst,addr).c_str());
@@ -1920,115 +1956,115 @@ Insn* getInsn(uint32_t inst, uint32_t addr){
   return ins;
 }
 
-static Insn* getRType(uint32_t inst, uint32_t addr)
+static Insn* getRType(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t funct = inst & 63;
   switch(funct)
     {
     case 0x00:
-      return new insn_sll(inst, addr);
+      return a.make<insn_sll>(inst, addr);
       break;
     case 0x01:
-      return new insn_movci(inst, addr);
+      return a.make<insn_movci>(inst, addr);
       break;
     case 0x02:
-      return new insn_srl(inst, addr);
+      return a.make<insn_srl>(inst, addr);
       break;
     case 0x03:
-      return new insn_sra(inst, addr);
+      return a.make<insn_sra>(inst, addr);
       break;
     case 0x04:
-      return new insn_sllv(inst, addr);
+      return a.make<insn_sllv>(inst, addr);
       break;
     case 0x05:
-      return new insn_monitor(inst, addr);
+      return a.make<insn_monitor>(inst, addr);
       break;
     case 0x06:
-      return new insn_srlv(inst, addr);
+      return a.make<insn_srlv>(inst, addr);
       break;
     case 0x07:
-      return new insn_srav(inst, addr);
+      return a.make<insn_srav>(inst, addr);
       break;
     case 0x08:
-      return new insn_jr(inst, addr);
+      return a.make<insn_jr>(inst, addr);
       break;
     case 0x09:
-      return new insn_jalr(inst, addr);
+      return a.make<insn_jalr>(inst, addr);
       break;
     case 0x0B:
-      return new insn_movn(inst, addr);
+      return a.make<insn_movn>(inst, addr);
       break;
     case 0x0A:
-      return new insn_movz(inst, addr);
+      return a.make<insn_movz>(inst, addr);
       break;
     case 0x0C: 
-      return new insn_syscall(inst, addr);
+      return a.make<insn_syscall>(inst, addr);
       break;
     case 0x0f:
-      return new insn_sync(inst, addr);
+      return a.make<insn_sync>(inst, addr);
       break;
     case 0x0D:
-      return new insn_break(inst, addr);
+      return a.make<insn_break>(inst, addr);
       break;
     case 0x10:
-      return new insn_mfhi(inst, addr);
+      return a.make<insn_mfhi>(inst, addr);
       break;
     case 0x11:
-      return new insn_mthi(inst, addr);
+      return a.make<insn_mthi>(inst, addr);
       break;
     case 0x12:
-      return new insn_mflo(inst, addr);
+      return a.make<insn_mflo>(inst, addr);
       break;
     case 0x13:
-      return new insn_mtlo(inst, addr);
+      return a.make<insn_mtlo>(inst, addr);
       break;
     case 0x18:
-      return new insn_mult(inst, addr);
+      return a.make<insn_mult>(inst, addr);
       break;
     case 0x19:
-      return new insn_multu(inst, addr);
+      return a.make<insn_multu>(inst, addr);
       break;
     case 0x1A:
-      return new insn_div(inst, addr);
+      return a.make<insn_div>(inst, addr);
       break;
     case 0x1B:
-      return new insn_divu(inst, addr);
+      return a.make<insn_divu>(inst, addr);
       break;
     case 0x20: 
-      return new insn_add(inst, addr);
+      return a.make<insn_add>(inst, addr);
       break;
     case 0x21:
-      return new insn_addu(inst, addr);
+      return a.make<insn_addu>(inst, addr);
       break;
     case 0x22:
-      return new insn_sub(inst, addr);
+      return a.make<insn_sub>(inst, addr);
       break;
     case 0x23:
-      return new insn_subu(inst, addr);
+      return a.make<insn_subu>(inst, addr);
       break;
     case 0x24:
-      return new insn_and(inst, addr);
+      return a.make<insn_and>(inst, addr);
       break;
     case 0x25: 
-      return new insn_or(inst, addr);
+      return a.make<insn_or>(inst, addr);
       break;
     case 0x26:
-      return new insn_xor(inst, addr);
+      return a.make<insn_xor>(inst, addr);
       break;
     case 0x27:
-      return new insn_nor(inst, addr);
+      return a.make<insn_nor>(inst, addr);
       break;
     case 0x2A: 
-      return new insn_slt(inst, addr);
+      return a.make<insn_slt>(inst, addr);
       break;
     case 0x2B:
-      return new insn_sltu(inst, addr);
+      return a.make<insn_sltu>(inst, addr);
       break;
     case 0x30: 
-      return new insn_tge(inst, addr);
+      return a.make<insn_tge>(inst, addr);
       break;
     case 0x34:
-      return new insn_teq(inst, addr);
+      return a.make<insn_teq>(inst, addr);
       break;
     default:
       printf("unhandled RType instruction\n");
@@ -2039,62 +2075,62 @@ static Insn* getRType(uint32_t inst, uint32_t addr)
 }
 
 
-static Insn* getSpecial2(uint32_t inst, uint32_t addr)
+static Insn* getSpecial2(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t funct = inst & 63;
   switch(funct)
     {
     case(0x0):
-      return new insn_madd(inst,addr);
+      return a.make<insn_madd>(inst, addr);
     case(0x1):
-      return new insn_maddu(inst,addr);
+      return a.make<insn_maddu>(inst, addr);
     case(0x2):
-      return new insn_mul(inst,addr);
+      return a.make<insn_mul>(inst, addr);
     case 0x4:
-      return new insn_msub(inst,addr);
+      return a.make<insn_msub>(inst, addr);
     case(0x20):
-      return new insn_clz(inst,addr);
+      return a.make<insn_clz>(inst, addr);
     }
   return nullptr;
 }
-static Insn* getSpecial3(uint32_t inst, uint32_t addr)
+static Insn* getSpecial3(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t funct = inst & 63;
   uint32_t op = (inst>>6) & 31;
   if(funct == 32) {
     switch(op) {
     case 0x10:
-      return new insn_seb(inst, addr);
+      return a.make<insn_seb>(inst, addr);
       break;
     case 0x18:
-      return new insn_seh(inst, addr);
+      return a.make<insn_seh>(inst, addr);
       break;
     }
   }
   else if(funct == 0)
-    return new insn_ext(inst, addr);
+    return a.make<insn_ext>(inst, addr);
   else if(funct == 4) 
-    return new insn_ins(inst, addr);
+    return a.make<insn_ins>(inst, addr);
   else
     return nullptr;
   /* needed to make clang happy */
   return nullptr;
 }
-static Insn* getCoproc0(uint32_t inst, uint32_t addr)
+static Insn* getCoproc0(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t functField = (inst>>21) & 31;
   switch(functField) {
   case 0x0:
-    return new insn_mfc0(inst, addr);
+    return a.make<insn_mfc0>(inst, addr);
     break;
   case 0x4:
-    return new insn_mtc0(inst, addr);
+    return a.make<insn_mtc0>(inst, addr);
     break;
   }
   return nullptr;
 }
 
-static Insn* getCoproc1(uint32_t inst, uint32_t addr)
+static Insn* getCoproc1(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t opcode = inst>>26;
   uint32_t functField = (inst>>21) & 31;
@@ -2110,56 +2146,56 @@ static Insn* getCoproc1(uint32_t inst, uint32_t addr)
       switch(nd_tf)
 	{
 	case 0x0:
-	  return new insn_bc1f(inst, addr);
+	  return a.make<insn_bc1f>(inst, addr);
 	  break;
 	case 0x1:
-	  return new insn_bc1t(inst, addr);
+	  return a.make<insn_bc1t>(inst, addr);
 	  break;
 	case 0x2:
-	  return new insn_bc1fl(inst, addr);
+	  return a.make<insn_bc1fl>(inst, addr);
 	  break;
 	case 0x3:
-	  return new insn_bc1tl(inst, addr);
+	  return a.make<insn_bc1tl>(inst, addr);
 	  break;
 	}
     }
   else if((lowbits == 0) && ((functField==0x0) || (functField==0x4)))
     {
       if(functField == 0x0)
-	return new insn_mfc1(inst,addr);
+	return a.make<insn_mfc1>(inst, addr);
       else if(functField == 0x4)
-	return new insn_mtc1(inst,addr);
+	return a.make<insn_mtc1>(inst, addr);
     }
   else
     {
       if((lowop >> 4) == 3)
-	return new insn_c(inst, addr);
+	return a.make<insn_c>(inst, addr);
       else {
 	switch(lowop) {
 	case 0x0:
-	  return new insn_fadd(inst, addr);
+	  return a.make<insn_fadd>(inst, addr);
 	case 0x1:
-	  return new insn_fsub(inst, addr);
+	  return a.make<insn_fsub>(inst, addr);
 	case 0x2:
-	  return new insn_fmul(inst, addr);
+	  return a.make<insn_fmul>(inst, addr);
 	case 0x3:
-	  return new insn_fdiv(inst, addr);
+	  return a.make<insn_fdiv>(inst, addr);
 	case 0x4:
-	  return new insn_fsqrt(inst, addr);
+	  return a.make<insn_fsqrt>(inst, addr);
 	case 0x6:
-	  return new insn_fmov(inst,addr);
+	  return a.make<insn_fmov>(inst, addr);
 	case 0xd:
-	  return new insn_truncw(inst, addr);
+	  return a.make<insn_truncw>(inst, addr);
 	case 0x11:
-	  return new insn_fmovc(inst, addr);
+	  return a.make<insn_fmovc>(inst, addr);
 	case 0x12:
-	  return new insn_fmovz(inst, addr);
+	  return a.make<insn_fmovz>(inst, addr);
 	case 0x13:
-	  return new insn_fmovn(inst, addr);
+	  return a.make<insn_fmovn>(inst, addr);
 	case 0x20:
-	  return new insn_cvts(inst, addr);
+	  return a.make<insn_cvts>(inst, addr);
 	case 0x21:
-	  return new insn_cvtd(inst, addr);
+	  return a.make<insn_cvtd>(inst, addr);
 	default:
 	  printf("line %d : lowop = %x\n", __LINE__, lowop);
 	  exit(-1);
@@ -2169,7 +2205,7 @@ static Insn* getCoproc1(uint32_t inst, uint32_t addr)
     }
   return nullptr;
 }
-static Insn* getIType(uint32_t inst, uint32_t addr)
+static Insn* getIType(arena &a, uint32_t inst, uint32_t addr)
 {
   uint32_t opcode = inst>>26;
   switch(opcode)
@@ -2180,85 +2216,85 @@ static Insn* getIType(uint32_t inst, uint32_t addr)
       switch(rt) 
 	{
 	case 0:
-	  br = new insn_bltz(inst, addr);
+	  br = a.make<insn_bltz>(inst, addr);
 	  break;
 	case 1:
-	  br = new insn_bgez(inst, addr);
+	  br = a.make<insn_bgez>(inst, addr);
 	  break;
 	case 2:
-	  br = new insn_bltzl(inst, addr);
+	  br = a.make<insn_bltzl>(inst, addr);
 	  break;
 	case 3:
-	  br = new insn_bgezl(inst, addr);
+	  br = a.make<insn_bgezl>(inst, addr);
 	  break;
 	}
       return br;
       break;
     }
     case 0x04: 
-      return new insn_beq(inst,addr); 
+      return a.make<insn_beq>(inst, addr); 
     case 0x05: 
-      return new insn_bne(inst,addr); 
+      return a.make<insn_bne>(inst, addr); 
     case 0x06: 
-      return new insn_blez(inst,addr); 
+      return a.make<insn_blez>(inst, addr); 
     case 0x07: 
-      return new insn_bgtz(inst,addr);
+      return a.make<insn_bgtz>(inst, addr);
     case 0x08:  
-      return new insn_addi(inst,addr); 
+      return a.make<insn_addi>(inst, addr); 
     case 0x09: 
-      return new insn_addiu(inst,addr); 
+      return a.make<insn_addiu>(inst, addr); 
     case 0x0a: 
-      return new insn_slti(inst,addr); 
+      return a.make<insn_slti>(inst, addr); 
     case 0x0b: 
-      return new insn_sltiu(inst,addr); 
+      return a.make<insn_sltiu>(inst, addr); 
     case 0x0c:
-      return new insn_andi(inst,addr); 
+      return a.make<insn_andi>(inst, addr); 
     case 0x0d: 
-      return new insn_ori(inst,addr); 
+      return a.make<insn_ori>(inst, addr); 
     case 0x0e: 
-      return new insn_xori(inst,addr);
+      return a.make<insn_xori>(inst, addr);
     case 0x0f:
-      return new insn_lui(inst,addr); 
+      return a.make<insn_lui>(inst, addr); 
     case 0x14: 
-      return new insn_beql(inst, addr);
+      return a.make<insn_beql>(inst, addr);
     case 0x15: 
-      return new insn_bnel(inst,addr); 
+      return a.make<insn_bnel>(inst, addr); 
     case 0x16:
-      return new insn_blezl(inst, addr);
+      return a.make<insn_blezl>(inst, addr);
     case 0x17:
-      return new insn_bgtzl(inst, addr);
+      return a.make<insn_bgtzl>(inst, addr);
     case 0x20: 
-      return new insn_lb(inst,addr); 
+      return a.make<insn_lb>(inst, addr); 
     case 0x21: 
-      return new insn_lh(inst,addr);
+      return a.make<insn_lh>(inst, addr);
     case 0x22:
-      return new insn_lwl(inst,addr);
+      return a.make<insn_lwl>(inst, addr);
     case 0x23: 
-      return new insn_lw(inst,addr); 
+      return a.make<insn_lw>(inst, addr); 
     case 0x24: 
-      return new insn_lbu(inst,addr);
+      return a.make<insn_lbu>(inst, addr);
     case 0x25:
-      return new insn_lhu(inst,addr); 
+      return a.make<insn_lhu>(inst, addr); 
     case 0x26:
-      return new insn_lwr(inst, addr);
+      return a.make<insn_lwr>(inst, addr);
     case 0x28: 
-      return new insn_sb(inst,addr); 
+      return a.make<insn_sb>(inst, addr); 
     case 0x29:  
-      return new insn_sh(inst,addr); 
+      return a.make<insn_sh>(inst, addr); 
     case 0x2a:
-      return new insn_swl(inst,addr);
+      return a.make<insn_swl>(inst, addr);
     case 0x2B: 
-      return new insn_sw(inst,addr); 
+      return a.make<insn_sw>(inst, addr); 
     case 0x2e:
-      return new insn_swr(inst,addr);
+      return a.make<insn_swr>(inst, addr);
     case 0x31:
-      return new insn_lwc1(inst, addr);
+      return a.make<insn_lwc1>(inst, addr);
     case 0x35: 
-      return new insn_ldc1(inst,addr); 
+      return a.make<insn_ldc1>(inst, addr); 
     case 0x39:
-      return new insn_swc1(inst, addr);
+      return a.make<insn_swc1>(inst, addr);
     case 0x3d: 
-      return new insn_sdc1(inst,addr); 
+      return a.make<insn_sdc1>(inst, addr); 
     }
     return nullptr;
 }
@@ -2573,7 +2609,7 @@ bool insn_sb::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTbl)
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vRT = regTbl.gprTbl[rt];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(vEA, llvm::Type::getInt64Ty(*(cfg->Context)));
+  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 1), llvm::Type::getInt64Ty(*(cfg->Context)));
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   llvm::Value *vPtr = cfg->myIRBuilder->CreateBitCast(vGEP,llvm::Type::getInt8PtrTy(*(cfg->Context)));
@@ -2588,7 +2624,7 @@ bool insn_sh::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTbl)
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vRT = regTbl.gprTbl[rt];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(vEA, llvm::Type::getInt64Ty(cxt));
+  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 2), llvm::Type::getInt64Ty(cxt));
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   llvm::Value *vPtr = cfg->myIRBuilder->CreateBitCast(vGEP, llvm::Type::getInt16PtrTy(cxt));
@@ -2620,7 +2656,7 @@ bool insn_lbu::generateIR(cfgBasicBlock *cBB, Insn *nInst,llvmRegTables& regTbl)
   llvm::Value *vIMM = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*(cfg->Context)),simm);
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(vEA, llvm::Type::getInt64Ty(*(cfg->Context)));
+  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 1), llvm::Type::getInt64Ty(*(cfg->Context)));
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   std::string loadName = "lbu_" + std::to_string(cfg->getuuid()++) + "_" + toStringHex(addr);
@@ -2637,7 +2673,7 @@ bool insn_lb::generateIR(cfgBasicBlock *cBB, Insn *nInst,llvmRegTables& regTbl)
   llvm::Value *vIMM = llvm::ConstantInt::get(iType32,simm);
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(vEA, iType64);
+  llvm::Value *vZEA = cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 1), iType64);
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   std::string loadName = "lb_" + std::to_string(cfg->getuuid()++) + "_" + toStringHex(addr);
@@ -2650,7 +2686,7 @@ bool insn_lh::generateIR(cfgBasicBlock *cBB, Insn *nInst,llvmRegTables& regTbl)
   llvm::Value *vIMM = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*(cfg->Context)),simm);
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(vEA, llvm::Type::getInt64Ty(*(cfg->Context)));
+  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 2), llvm::Type::getInt64Ty(*(cfg->Context)));
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   llvm::Value *vPtr = cfg->myIRBuilder->CreateBitCast(vGEP, llvm::Type::getInt16PtrTy(*(cfg->Context)));
@@ -2670,7 +2706,7 @@ bool insn_lhu::generateIR(cfgBasicBlock *cBB, Insn *nInst,llvmRegTables& regTbl)
   llvm::Value *vIMM = llvm::ConstantInt::get(iType32, simm);
   llvm::Value *vRS = regTbl.gprTbl[rs];
   llvm::Value *vEA = cfg->myIRBuilder->CreateAdd(vRS, vIMM);
-  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(vEA, iType64);
+  llvm::Value *vZEA =  cfg->myIRBuilder->CreateZExt(subWordEA(vEA, 2), iType64);
   llvm::Value *vMem = cfg->blockArgMap["mem"];
   llvm::Value *vGEP = cfg->myIRBuilder->MakeGEP(vMem, vZEA);
   llvm::Value *vPtr = cfg->myIRBuilder->CreateBitCast(vGEP, llvm::Type::getInt16PtrTy(cxt));
@@ -2975,14 +3011,17 @@ bool insn_jal::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTbl
   llvm::LLVMContext &cxt = *(cfg->Context);
   regTbl.gprTbl[31] = llvm::ConstantInt::get(llvm::Type::getInt32Ty(cxt),(addr+8));
   nInst->codeGen(cBB, nullptr, regTbl);
-  cfgBasicBlock *nBB = *(cBB->succs.begin());
-#if 0
-  if(cBB->succs.size() != 1) {
-    printf("not 1 succ in a jal (%zu succs)\n", cBB->succs.size());
-    exit(-1);
+  if(cBB->nativeCallReturn(cfg)) {
+    cfg->generateNativeCall(cBB, regTbl, jaddr, addr+8);
+    cBB->hasTermBranchOrJump = true;
+    return true;
   }
-#endif
-  cfg->myIRBuilder->CreateBr(nBB->lBB);
+  cfg->generateRASPush(addr+8);
+  llvm::BasicBlock *tBB = cBB->getSuccLLVMBasicBlock(jaddr);
+  if(tBB == nullptr) {
+    tBB = cfg->generateAbortBasicBlock(jaddr, regTbl, cBB, nullptr, addr);
+  }
+  cfg->myIRBuilder->CreateBr(tBB);
   cBB->hasTermBranchOrJump = true;
 
   return true;
@@ -3012,6 +3051,8 @@ bool insn_jr::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTbl)
       llvm::Value *vCmp = cfg->myIRBuilder->CreateICmpEQ(vNPC, vAddr);
       cmpz.push_back(vCmp);
     }
+  /* only returns through $ra consult the return stack */
+  llvm::Value *vRetLink = (rs == 31) ? cfg->generateRASPop(vNPC) : nullptr;
   nInst->codeGen(cBB, nullptr, regTbl);
 
   size_t p = 0;
@@ -3025,7 +3066,8 @@ bool insn_jr::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTbl)
       cBB->jrMap[next->lBB] = fallT[pp];
       cfg->myIRBuilder->SetInsertPoint(fallT[p-1]);
     }
-  llvm::BasicBlock *abortBlock = cfg->generateAbortBasicBlock(vNPC, regTbl, cBB, nullptr);
+  llvm::BasicBlock *abortBlock = cfg->generateAbortBasicBlock(vNPC, regTbl, cBB, nullptr,
+							      nullptr, vRetLink);
   cfg->myIRBuilder->CreateBr(abortBlock);
 
   cBB->hasTermBranchOrJump = true;
@@ -3053,6 +3095,7 @@ bool insn_jalr::generateIR(cfgBasicBlock *cBB, Insn *nInst, llvmRegTables& regTb
   }
   
   nInst->codeGen(cBB, nullptr, regTbl);
+  cfg->generateRASPush(addr+8);
 
   size_t p = 0;
   fallT[p++] = llvm::BasicBlock::Create(cxt,"ft",cfg->blockFunction);
@@ -9,6 +9,7 @@
 class cfgBasicBlock;
 class regionCFG;
 class llvmRegTables;
+class arena;
 
 class Insn;
 enum regEnum {uninit=0,constant,variant};
@@ -19,7 +20,8 @@ struct regState {
   uint32_t v;
 };
 
-Insn* getInsn(uint32_t inst, uint32_t addr);
+/* instructions live in the region's arena */
+Insn* getInsn(arena &a, uint32_t inst, uint32_t addr);
 
 class Insn : public ssaInsn {
 protected:
@@ -30,6 +32,7 @@ protected:
   
 public:
   llvm::Value *byteSwap(llvm::Value *v);
+  llvm::Value *subWordEA(llvm::Value *vEA, uint32_t bytes);
 
   void saveInstAddress();
   void set(regionCFG *cfg, cfgBasicBlock *cBB);
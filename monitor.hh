@@ -8,6 +8,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "guestMem.hh"
 
 static const uint32_t K1SIZE = 0x80000000;
 
@@ -46,7 +50,7 @@ struct stat32_t {
 static void getNextBlock(state_t *s);
 
 
-template<bool EL>
+template<bool EL, bool HE>
 void _monitorBody(uint32_t inst, state_t *s) {
   uint32_t reason = ((inst >> RSVD_INSTRUCTION_ARG_SHIFT) & RSVD_INSTRUCTION_ARG_MASK) >> 1;
   //std::cout << "reason = " << reason << ", return address " << std::hex << s->gpr[31] << std::dec << "\n";
@@ -56,10 +60,10 @@ void _monitorBody(uint32_t inst, state_t *s) {
     case 6: {
       /* int open(char *path, int flags) */
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a0);
-      const char *path = (char*)(s->mem + uptr);
+      std::string path = guestString(s->mem, uptr);
       //std::cout << "open " << path << "\n";
       int flags = remapIOFlags(s->gpr[R_a1]);
-      int fd = open(path, flags, S_IRUSR|S_IWUSR);
+      int fd = open(path.c_str(), flags, S_IRUSR|S_IWUSR);
       if(fd != -1) {
 	globals::openFileDes.insert(fd);
       }
@@ -69,13 +73,29 @@ void _monitorBody(uint32_t inst, state_t *s) {
     case 7: {
       /* int read(int file,char *ptr,int len) */
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a1);
-      s->gpr[R_v0] = read(s->gpr[R_a0], (char*)(s->mem + uptr), s->gpr[R_a2]);
+      if(not(HE)) {
+	s->gpr[R_v0] = read(s->gpr[R_a0], (char*)(s->mem + uptr), s->gpr[R_a2]);
+      }
+      else {
+	std::vector<char> buf(static_cast<uint32_t>(s->gpr[R_a2]));
+	s->gpr[R_v0] = read(s->gpr[R_a0], buf.data(), buf.size());
+	if(s->gpr[R_v0] > 0) {
+	  copyToGuest(s->mem, uptr, buf.data(), s->gpr[R_v0]);
+	}
+      }
       break;
     }
     case 8: { 
       /* int write(int file, char *ptr, int len) */
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a1);
-      s->gpr[R_v0] = (int32_t)write(s->gpr[R_a0], (void*)(s->mem + uptr), s->gpr[R_a2]);
+      if(not(HE)) {
+	s->gpr[R_v0] = (int32_t)write(s->gpr[R_a0], (void*)(s->mem + uptr), s->gpr[R_a2]);
+      }
+      else {
+	std::vector<char> buf(static_cast<uint32_t>(s->gpr[R_a2]));
+	copyFromGuest(buf.data(), s->mem, uptr, buf.size());
+	s->gpr[R_v0] = (int32_t)write(s->gpr[R_a0], buf.data(), buf.size());
+      }
       break;
     }
     case 9: /* lseek */
@@ -92,10 +112,11 @@ void _monitorBody(uint32_t inst, state_t *s) {
       break;
     case 13: { /* fstat */
       struct stat native_stat;
-      stat32_t *host_stat = nullptr;
+      stat32_t guest_stat;
+      stat32_t *host_stat = &guest_stat;
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a1);
       s->gpr[R_v0] = fstat(s->gpr[R_a0], &native_stat);
-      host_stat = reinterpret_cast<stat32_t*>(s->mem + uptr); 
+      copyFromGuest(host_stat, s->mem, uptr, sizeof(stat32_t));
 
       host_stat->st_dev = bswap<EL>((uint32_t)native_stat.st_dev);
       host_stat->st_ino = bswap<EL>((uint16_t)native_stat.st_ino);
@@ -109,6 +130,7 @@ void _monitorBody(uint32_t inst, state_t *s) {
       host_stat->_st_ctime = 0;
       host_stat->st_blksize = bswap<EL>((uint32_t)native_stat.st_blksize);
       host_stat->st_blocks = bswap<EL>((uint32_t)native_stat.st_blocks);
+      copyToGuest(s->mem, uptr, host_stat, sizeof(stat32_t));
       break;
     }
     case 33: {
@@ -127,7 +149,7 @@ void _monitorBody(uint32_t inst, state_t *s) {
       }
       tp32.tv_sec = bswap<EL>((uint32_t)tp.tv_sec);
       tp32.tv_usec = bswap<EL>((uint32_t)tp.tv_usec);      
-      *reinterpret_cast<timeval32_t*>(s->mem + uptr) = tp32;
+      copyToGuest(s->mem, uptr, &tp32, sizeof(tp32));
       s->gpr[R_v0] = 0;
       break;
     }
@@ -150,31 +172,32 @@ void _monitorBody(uint32_t inst, state_t *s) {
       tms32_buf.tms_stime = bswap<EL>((uint32_t)tms_buf.tms_stime);
       tms32_buf.tms_cutime = bswap<EL>((uint32_t)tms_buf.tms_cutime);
       tms32_buf.tms_cstime = bswap<EL>((uint32_t)tms_buf.tms_cstime);      
-      *((tms32_t*)(s->mem + uptr)) = tms32_buf;
+      copyToGuest(s->mem, uptr, &tms32_buf, sizeof(tms32_buf));
       break;
     }
     case 35:
       /* int getargs(char **argv) */
       for(int i = 0; i < std::min(MARGS, globals::sArgc); i++) {
 	uint32_t arrayAddr = ((uint32_t)s->gpr[R_a0])+4*i;
-	uint32_t ptr = bswap<EL>(*((uint32_t*)(s->mem + arrayAddr)));
-	strcpy((char*)(s->mem + ptr), globals::sArgv[i]);
+	uint32_t ptr = loadGuest<EL,HE,uint32_t>(s->mem, arrayAddr);
+	copyToGuest(s->mem, ptr, globals::sArgv[i], strlen(globals::sArgv[i])+1);
       }
       s->gpr[R_v0] = globals::sArgc;
       break;
     case 37: {
       /*char *getcwd(char *buf, uint32_t size) */
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a0);
-      char *buf = (char*)(s->mem + uptr);
-      assert(getcwd(buf, (uint32_t)s->gpr[R_a1])!=nullptr);
+      std::vector<char> buf(static_cast<uint32_t>(s->gpr[R_a1]));
+      assert(getcwd(buf.data(), buf.size())!=nullptr);
+      copyToGuest(s->mem, uptr, buf.data(), strlen(buf.data())+1);
       s->gpr[R_v0] = s->gpr[R_a0];
       break;
     }
     case 38: {
       /* int chdir(const char *path); */
       uint32_t uptr = *reinterpret_cast<uint32_t*>(s->gpr + R_a0);
-      const char *path = (char*)(s->mem + uptr);
-      s->gpr[R_v0] = chdir(path);
+      std::string path = guestString(s->mem, uptr);
+      s->gpr[R_v0] = chdir(path.c_str());
       break;
     }
 #if 1
@@ -183,8 +206,7 @@ void _monitorBody(uint32_t inst, state_t *s) {
       std::cout << "disassembling " << s->gpr[R_a1] << " insns\n";
       for(int i = 0; i < s->gpr[R_a1]; i++) {
 	uint32_t addr =s->gpr[R_a0]+4*i;
-	uint8_t *ptr = s->mem + addr;
-	uint32_t inst = bswap<EL>(*(uint32_t*)ptr);
+	uint32_t inst = loadGuest<EL,HE,uint32_t>(s->mem, addr);
 	std::cout << "\t"
 		  << std::hex << addr << ":" << std::dec
 		  << getAsmString(inst,addr)
@@ -208,9 +230,9 @@ void _monitorBody(uint32_t inst, state_t *s) {
       s->gpr[R_v0] = s->icnt;
       break;
     case 55: 
-      *reinterpret_cast<uint32_t*>(s->mem + (uint32_t)s->gpr[R_a0] + 0) = bswap<EL>(K1SIZE);
-      *reinterpret_cast<uint32_t*>(s->mem + (uint32_t)s->gpr[R_a0] + 4) = 0;
-      *reinterpret_cast<uint32_t*>(s->mem + (uint32_t)s->gpr[R_a0] + 8) = 0;      
+      storeGuest<EL,HE,uint32_t>(s->mem, (uint32_t)s->gpr[R_a0] + 0, K1SIZE);
+      storeGuest<EL,HE,uint32_t>(s->mem, (uint32_t)s->gpr[R_a0] + 4, 0);
+      storeGuest<EL,HE,uint32_t>(s->mem, (uint32_t)s->gpr[R_a0] + 8, 0);
       break;
     default:
       printf("unhandled monitor instruction (reason = %d)\n", reason);
@@ -220,10 +242,10 @@ void _monitorBody(uint32_t inst, state_t *s) {
   s->pc = s->gpr[31];
 }
 
-template <bool EL>
+template <bool EL, bool HE>
 void _monitor(uint32_t inst, state_t *s) {
   globals::cBB->setTermAddr(s->pc);
-  _monitorBody<EL>(inst, s);
+  _monitorBody<EL,HE>(inst, s);
   getNextBlock(s);
 }
 
@@ -0,0 +1,86 @@
+#ifndef __PCTABLE_HH__
+#define __PCTABLE_HH__
+
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <array>
+
+/* sparse two-level table indexed by guest pc,
+ * a default constructed T marks an empty slot */
+template <typename T>
+class pcTable {
+private:
+  const static uint32_t pageBits = 14;
+  const static uint32_t pageLen = 1U << pageBits;
+  const static uint32_t dirLen = 1U << (30 - pageBits);
+  std::array<T*, dirLen> dir;
+  size_t nEntries = 0;
+  static uint32_t dirIdx(uint32_t pc) {
+    return pc >> (pageBits + 2);
+  }
+  static uint32_t pageIdx(uint32_t pc) {
+    return (pc >> 2) & (pageLen - 1);
+  }
+public:
+  pcTable() {
+    dir.fill(nullptr);
+  }
+  ~pcTable() {
+    clear();
+  }
+  pcTable(const pcTable &other) = delete;
+  pcTable &operator=(const pcTable &other) = delete;
+  T get(uint32_t pc) const {
+    const T *page = dir[dirIdx(pc)];
+    if((page == nullptr) or (pc & 3)) {
+      return T();
+    }
+    return page[pageIdx(pc)];
+  }
+  void set(uint32_t pc, const T &v) {
+    assert((pc & 3) == 0);
+    T *&page = dir[dirIdx(pc)];
+    if(page == nullptr) {
+      if(v == T()) {
+	return;
+      }
+      page = new T[pageLen]();
+    }
+    T &e = page[pageIdx(pc)];
+    if((e == T()) and not(v == T())) {
+      nEntries++;
+    }
+    else if(not(e == T()) and (v == T())) {
+      nEntries--;
+    }
+    e = v;
+  }
+  size_t size() const {
+    return nEntries;
+  }
+  void clear() {
+    for(auto &page : dir) {
+      delete [] page;
+      page = nullptr;
+    }
+    nEntries = 0;
+  }
+  /* visits occupied slots in pc order */
+  template <typename F>
+  void forEach(F f) const {
+    for(uint32_t d = 0; d < dirLen; d++) {
+      const T *page = dir[d];
+      if(page == nullptr) {
+	continue;
+      }
+      for(uint32_t i = 0; i < pageLen; i++) {
+	if(not(page[i] == T())) {
+	  f((d << (pageBits + 2)) | (i << 2), page[i]);
+	}
+      }
+    }
+  }
+};
+
+#endif
@@ -3,7 +3,12 @@
 #include <ostream>
 #include <limits>
 #include <fstream>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <boost/dynamic_bitset.hpp>
+#include <cstddef>
 #include <fcntl.h>
 
 #include "regionCFG.hh"
@@ -12,9 +17,23 @@
 #include "debugSymbols.hh"
 #include "globals.hh"
 #include "saveState.hh"
+#include "codeHeap.hh"
 
 static regionCFG *currCFG = nullptr;
 
+/* background code generation : the guest thread builds IR
+ * and queues it, workers run the jit and hand regions back */
+static std::mutex compileMtx;
+static std::condition_variable compileCV;
+static std::deque<regionCFG*> compileQueue, compiledQueue;
+static std::vector<std::thread> compileThreads;
+static std::atomic<size_t> nCompiled(0);
+static size_t nInFlight = 0;
+static bool stopCompiling = false;
+
+/* just enough cleanup for the first tier */
+static const std::string quickPasses = "function(early-cse,simplifycfg)";
+
 /* Implementation from Muchnick and Lengauer-Tarjan TOPLAS 
  * paper. Vague understanding from Appel. */
 class LengauerTarjanDominators {
@@ -22,24 +41,25 @@ private:
   std::vector<cfgBasicBlock*> &blocks;
   cfgBasicBlock *root = nullptr;
   ssize_t dfsCounter = 1;
+  /* all indexed by block id, except Ndfs by dfs number */
   /* Parent in the DFS tree */
-  std::map<cfgBasicBlock*, cfgBasicBlock*> Parent;
+  std::vector<cfgBasicBlock*> Parent;
   /* Ancestor chain in DFS tree */
-  std::map<cfgBasicBlock*, cfgBasicBlock*> Ancestor;
-  std::map<cfgBasicBlock*, cfgBasicBlock*> Label;
-  std::map<cfgBasicBlock*, std::set<cfgBasicBlock*>> Buckets;
-  std::map<ssize_t, cfgBasicBlock*> Ndfs;
-  std::map<cfgBasicBlock*, ssize_t> Sdno;
+  std::vector<cfgBasicBlock*> Ancestor;
+  std::vector<cfgBasicBlock*> Label;
+  std::vector<std::vector<cfgBasicBlock*>> Buckets;
+  std::vector<cfgBasicBlock*> Ndfs;
+  std::vector<ssize_t> Sdno;
   
   void DFS(cfgBasicBlock *bb) {
-    Sdno.at(bb) = dfsCounter;
+    Sdno[bb->id] = dfsCounter;
     Ndfs[dfsCounter] = bb;
-    Label[bb] = bb;
-    Ancestor[bb] = nullptr;
+    Label[bb->id] = bb;
+    Ancestor[bb->id] = nullptr;
     dfsCounter++;
     for(cfgBasicBlock *nbb : bb->getSuccs()) {
-      if(Sdno.at(nbb) == 0) {
-	Parent[nbb] = bb;
+      if(Sdno[nbb->id] == 0) {
+	Parent[nbb->id] = bb;
 	DFS(nbb);
       }
     }
@@ -47,73 +67,79 @@ private:
   /* these methods are from Lengauer-Tarjan paper
    * and implement O(n*lg(n)) scheme */
   void Link(cfgBasicBlock *v, cfgBasicBlock *w) {
-    Ancestor.at(w) = v;
+    Ancestor[w->id] = v;
   }
   void Compress(cfgBasicBlock *bb) {
-    if(Ancestor.at(Ancestor.at(bb))) {
-      Compress(Ancestor.at(bb));
-      if(Sdno.at(Label.at(Ancestor.at(bb))) < Sdno.at(Label.at(bb))) {
-	Label.at(bb) = Label.at(Ancestor.at(bb));
+    cfgBasicBlock *a = Ancestor[bb->id];
+    if(Ancestor[a->id]) {
+      Compress(a);
+      if(Sdno[Label[a->id]->id] < Sdno[Label[bb->id]->id]) {
+	Label[bb->id] = Label[a->id];
       }
-      Ancestor.at(bb) = Ancestor.at(Ancestor.at(bb));
+      Ancestor[bb->id] = Ancestor[a->id];
     }
   }
   cfgBasicBlock *Eval(cfgBasicBlock *bb) {
-    if(!Ancestor.at(bb)) {
+    if(!Ancestor[bb->id]) {
       return bb;
     }
     else {
       Compress(bb);
-      return Label.at(bb);
+      return Label[bb->id];
     }
   }
   
 public:
   LengauerTarjanDominators(std::vector<cfgBasicBlock*> &blocks) : blocks(blocks) {}
   void operator()() {
+    size_t n = blocks.size();
+    Parent.assign(n, nullptr);
+    Ancestor.assign(n, nullptr);
+    Label.assign(n, nullptr);
+    Buckets.assign(n, std::vector<cfgBasicBlock*>());
+    Ndfs.assign(n+1, nullptr);
+    Sdno.assign(n, 0);
     for(cfgBasicBlock *bb : blocks) {
       if(bb->getPreds().empty()) {
 	assert(root==nullptr);
 	root = bb;
       }
-      Sdno[bb] = 0;
-      Parent[bb] = nullptr;
       bb->getIdom() = nullptr;
     }
     assert(root);
     DFS(root);
     
     for(ssize_t i = (dfsCounter-1); i > 1; i--) {
-      cfgBasicBlock *w = Ndfs.at(i);
-      ssize_t &sdom_w = Sdno.at(w);
+      cfgBasicBlock *w = Ndfs[i];
+      ssize_t &sdom_w = Sdno[w->id];
       for(cfgBasicBlock *pbb : w->getPreds()) {
 	cfgBasicBlock *u = Eval(pbb);
-	ssize_t sdom_u = Sdno.at(u);
+	ssize_t sdom_u = Sdno[u->id];
 	if(sdom_u < sdom_w) {
 	  sdom_w = sdom_u;
 	}
       }
-      Buckets[Ndfs.at(sdom_w)].insert(w);
-      Link(Parent.at(w), w);
+      Buckets[Ndfs[sdom_w]->id].push_back(w);
+      Link(Parent[w->id], w);
       /* need to understand - why parent bucket? */
-      std::set<cfgBasicBlock*> &pBucket = Buckets[Parent.at(w)];
+      std::vector<cfgBasicBlock*> &pBucket = Buckets[Parent[w->id]->id];
       for(cfgBasicBlock *v : pBucket) {
 	/* find ancestor with lowest semidominator */
 	cfgBasicBlock *u = Eval(v);
-	if(Sdno.at(u) < Sdno.at(v)) {
+	if(Sdno[u->id] < Sdno[v->id]) {
 	  /* idom is the semidominator */
 	  v->getIdom() = u;
 	}
 	else {
 	  /* must defer */
-	  v->getIdom() = Parent.at(w);
+	  v->getIdom() = Parent[w->id];
 	}
       }
       pBucket.clear();
     }
     for(ssize_t i = 2; i < dfsCounter; i++) {
-      cfgBasicBlock *w = Ndfs.at(i);
-      if(w->getIdom() != Ndfs.at(Sdno.at(w))) {
+      cfgBasicBlock *w = Ndfs[i];
+      if(w->getIdom() != Ndfs[Sdno[w->id]]) {
 	w->getIdom() = w->getIdom()->getIdom();
       }
     }
@@ -128,88 +154,88 @@ public:
 };
 
 
-template <typename T>
-class sortByIcnt {
-public:
-  bool operator() (const T& lhs, const T& rhs) const {
-    return lhs->getInscnt() > rhs->getInscnt();
-  }
-};
-
-template <typename T>
-bool aug_dfs(T *node,
-	     T *target,
-	     std::set<T*> &seen,
-	     std::list<T*> &visited,
-	     const std::set<T*> &init,
-	     size_t curr_len, size_t max_len) {
-  if(node == target) {
-    visited.push_back(node);
-    return true;
-  }
-  if(curr_len >= max_len) {
-    return false;
-  }
-
-  auto it = seen.find(node);
-  if(it != seen.end())
-    return false;
-  seen.insert(node);
-
-  if(node->hasJAL() /*or node->hasJR() or node->hasJALR()*/) {
-    bool viable = false;
-    for(T *nn : node->getSuccs()) {
-      if((nn == target) or (seen.find(nn) != seen.end())) {
-	viable = true;
-	break;
+/* adds the blocks on some path of at most maxLen edges from a
+ * source to a seed : one bfs forward from the sources, one back
+ * from the seeds over the blocks the first reached. a path ends
+ * at jr, jalr and monitor blocks and follows a call only into a seed */
+static void augPaths(const std::set<basicBlock*> &sources,
+		     const std::set<basicBlock*> &seeds,
+		     std::set<basicBlock*> &discovered,
+		     uint32_t maxLen) {
+  auto follows = [&seeds](const basicBlock *bb, basicBlock *nbb) {
+    if(bb->hasJR() or bb->hasJALR() or bb->hasMONITOR()) {
+      return false;
+    }
+    return not(bb->hasJAL()) or (seeds.find(nbb) != seeds.end());
+  };
+  std::unordered_map<basicBlock*, uint32_t> fwd, bwd;
+  std::vector<basicBlock*> q;
+  for(basicBlock *bb : sources) {
+    fwd[bb] = 0;
+    q.push_back(bb);
+  }
+  for(size_t i = 0; i < q.size(); i++) {
+    basicBlock *bb = q[i];
+    uint32_t d = fwd.at(bb);
+    if(d >= maxLen) {
+      continue;
+    }
+    for(basicBlock *nbb : bb->getSuccs()) {
+      if(follows(bb, nbb) and fwd.find(nbb) == fwd.end()) {
+	fwd[nbb] = d + 1;
+	q.push_back(nbb);
       }
     }
-    if(not(viable))
-      return false;
-  }
-  else if(node->hasJR() or node->hasJALR()) {
-    return false;
   }
-  else if(node->hasMONITOR()) {
-    return false;
+  q.clear();
+  for(basicBlock *bb : seeds) {
+    if(fwd.find(bb) != fwd.end()) {
+      bwd[bb] = 0;
+      q.push_back(bb);
+    }
   }
-
-  bool found_path = false;
-  size_t num_succs = node->getSuccs().size();
-  std::vector<T*> succs;
-  succs.reserve(num_succs);
-  for(T *n : node->getSuccs()) {
-    succs.push_back(n);
+  for(size_t i = 0; i < q.size(); i++) {
+    basicBlock *bb = q[i];
+    uint32_t d = bwd.at(bb);
+    if(d >= maxLen) {
+      continue;
+    }
+    for(basicBlock *pbb : bb->getPreds()) {
+      if(follows(pbb, bb) and (fwd.find(pbb) != fwd.end()) and
+	 (bwd.find(pbb) == bwd.end())) {
+	bwd[pbb] = d + 1;
+	q.push_back(pbb);
+      }
+    }
   }
-  
-  std::sort(succs.begin(), succs.end(), sortByIcnt<T*>());
-  
-  for(T *n : succs) {
-    if(aug_dfs(n, target, seen, visited, init, curr_len+1, max_len)) {
-      visited.push_back(node);
-      found_path = true;
+  for(const auto &f : fwd) {
+    auto it = bwd.find(f.first);
+    if(it != bwd.end() and (f.second + it->second) <= maxLen) {
+      discovered.insert(f.first);
     }
   }
-  return found_path;
 }
 
 
-template <typename T>
-void inducePhis(const std::set<cfgBasicBlock*> &defBBs, int id) {
-  std::list<cfgBasicBlock*> workList;
-  std::set<cfgBasicBlock*> checkSet;
-  for(cfgBasicBlock* cbb : defBBs) { 
-    workList.push_back(cbb); 
-    checkSet.insert(cbb); 
+template <typename T, typename L>
+void inducePhis(arena &a, const std::vector<cfgBasicBlock*> &blocks,
+		const cfgBlockSet &defBBs, int id, L live) {
+  std::vector<cfgBasicBlock*> workList;
+  boost::dynamic_bitset<> checkSet(blocks.size()), placed(blocks.size());
+  for(size_t i = defBBs.first(); i != cfgBlockSet::npos; i = defBBs.next(i)) {
+    workList.push_back(blocks[i]);
+    checkSet[i] = true;
   }
-  while(not(workList.empty()))  {
-    cfgBasicBlock *cbb = workList.front();
-    workList.pop_front();
+  for(size_t w = 0; w < workList.size(); w++) {
+    cfgBasicBlock *cbb = workList[w];
     for(cfgBasicBlock* dbb : cbb->dfrontier) {
-      T* phi = new T(id);
-      dbb->addPhiNode(phi);
-      if(checkSet.find(dbb) == checkSet.end()) {
-	checkSet.insert(dbb);
+      /* pruned, a dead register needs no merge */
+      if(not(placed[dbb->id]) and live(dbb)) {
+	placed[dbb->id] = true;
+	dbb->addPhiNode(a.make<T>(id));
+      }
+      if(not(checkSet[dbb->id])) {
+	checkSet[dbb->id] = true;
 	workList.push_back(dbb);
       }
     }
@@ -512,6 +538,62 @@ void regionCFG::getRegDefBlocks() {
       }
     }
   }
+
+  for(size_t i = 0; i < 32; i++) {
+    const cfgBlockSet &g = gprDefinitionBlocks[i], &f = fprDefinitionBlocks[i];
+    for(size_t b = g.first(); b != cfgBlockSet::npos; b = g.next(b)) {
+      cfgBlocks[b]->regsDefined.gpr[i] = true;
+    }
+    for(size_t b = f.first(); b != cfgBlockSet::npos; b = f.next(b)) {
+      cfgBlocks[b]->regsDefined.fpr[i] = true;
+    }
+  }
+  for(size_t i = 0; i < 5; i++) {
+    const cfgBlockSet &c = fcrDefinitionBlocks[i];
+    for(size_t b = c.first(); b != cfgBlockSet::npos; b = c.next(b)) {
+      cfgBlocks[b]->regsDefined.fcr[i] = true;
+    }
+  }
+  const cfgBlockSet &hl = hiloDefinitionBlocks;
+  for(size_t b = hl.first(); b != cfgBlockSet::npos; b = hl.next(b)) {
+    cfgBlocks[b]->regsDefined.hilo = true;
+  }
+
+  /* the callee of a host call may write any register,
+   * so the call redefines everything the region keeps live */
+  std::bitset<32> gprLive = allGprRead, fprLive;
+  std::bitset<5> fcrLive = allFcrRead;
+  bool hiloLive = allHiloRead[0] or not(hiloDefinitionBlocks.empty());
+  for(size_t i = 0; i < 32; i++) {
+    gprLive[i] = (i != 0) and (gprLive[i] or not(gprDefinitionBlocks[i].empty()));
+    /* a double lives in the even register of its pair */
+    fprLive[i] = (allFprTouched[i] != fprUseEnum::unused) and
+      not((allFprTouched[i] == fprUseEnum::doublePrec) and (i & 1));
+  }
+  for(size_t i = 0; i < 5; i++) {
+    fcrLive[i] = fcrLive[i] or not(fcrDefinitionBlocks[i].empty());
+  }
+  for(auto cbb : cfgBlocks) {
+    if(cbb->nativeCallReturn(this) == 0) {
+      continue;
+    }
+    for(size_t i = 0; i < 32; i++) {
+      if(gprLive[i]) {
+	gprDefinitionBlocks[i].insert(cbb);
+      }
+      if(fprLive[i]) {
+	fprDefinitionBlocks[i].insert(cbb);
+      }
+    }
+    for(size_t i = 0; i < 5; i++) {
+      if(fcrLive[i]) {
+	fcrDefinitionBlocks[i].insert(cbb);
+      }
+    }
+    if(hiloLive) {
+      hiloDefinitionBlocks.insert(cbb);
+    }
+  }
 }
 
 
@@ -534,15 +616,15 @@ void regionCFG::emulate(state_t *ss){
 
 bool regionCFG::allBlocksReachable(cfgBasicBlock *root) {
   std::queue<cfgBasicBlock*> q;
-  std::set<cfgBasicBlock*> v;
+  std::vector<bool> v(cfgBlocks.size(), false);
   std::list<cfgBasicBlock*> l;
   q.push(root);
   while(not(q.empty())) {
     cfgBasicBlock *cbb = q.front();
     q.pop();
-    if(v.find(cbb) != v.end())
+    if(v[cbb->id])
       continue;
-    v.insert(cbb);
+    v[cbb->id] = true;
     l.push_back(cbb);
     for(auto nbb : cbb->succs) {
       q.push(nbb);
@@ -557,15 +639,15 @@ bool regionCFG::allBlocksReachable(cfgBasicBlock *root) {
   }
 #endif
   for(auto bb : cfgBlocks) {
-    if(v.find(bb) == v.end()) {
+    if(not(v[bb->id])) {
       printf("couldn't find block %x:\n", bb->getEntryAddr());
     }
   }
   /*
-  print_var(v.size());
+  print_var(l.size());
   print_var(cfgBlocks.size());
   */
-  return v.size() == cfgBlocks.size();
+  return l.size() == cfgBlocks.size();
 }
 
 
@@ -573,12 +655,10 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
   compileTime = timestamp();
   std::set<basicBlock*> heads;
   std::map<basicBlock*, cfgBasicBlock*> cfgMap;
-  std::vector<basicBlock*> blockvec;
   std::set<basicBlock*> discovered; 
-  std::list<basicBlock*> visited;
-  std::set<basicBlock*> seen;
   
   currCFG = this;
+  quick = not(isBlock) and (replaces == nullptr) and (globals::tierUpIcnt != 0);
 
   for(size_t i = 0, n = regions.size(); i < n; i++) {
     heads.insert(regions[i][0]);
@@ -608,59 +688,29 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
 	      << " basicblocks\n";
   }
 
-  blockvec.reserve(blocks.size());
-  for(auto bb : blocks) {
-    blockvec.push_back(bb);
-  }
-  std::sort(blockvec.begin(), blockvec.end(), sortByIcnt<basicBlock*>());
-  
-  
-  switch(globals::cfgAug)
+
+  /* a function's blocks are already complete */
+  switch((isBlock or isFunc) ? cfgAugEnum::none : globals::cfgAug)
     {
     case cfgAugEnum::none:
       break;
       /* find paths to the head bb */      
     case cfgAugEnum::head:
-      for(auto bb: blockvec) {
-	visited.clear();
-	seen.clear();	
-	if(aug_dfs<basicBlock>(head, bb, seen, visited, blocks, 0, 1024)) {
-	  for(auto dbb : visited) {
-	    discovered.insert(dbb);
-	  }
-	}
-      }
+      augPaths(std::set<basicBlock*>{head}, blocks, discovered, 1024);
       break;
       /* find paths to any initially discovered bb */
     case cfgAugEnum::aggressive:
-      for(auto bb : blockvec) {
-	for(auto nbb : blockvec) {
-	  if(bb==nbb) continue;
-	  visited.clear();
-	  seen.clear();
-	  if(aug_dfs<basicBlock>(nbb, bb, seen, visited, blocks, 0, 1024)) {
-	    for(auto dbb : visited) {
-	      discovered.insert(dbb);
-	    }
-	  }
-	}
-      }
+      augPaths(blocks, blocks, discovered, 1024);
       break;
+      /* until no path adds a block, a new block lets
+       * more calls join the region */
     case cfgAugEnum::insane:
       discovered = blocks;
-      for(auto sit = discovered.begin(); sit != discovered.end(); ++sit) {
-	auto *bb = *sit;
-	for(auto dit = discovered.begin(); dit != discovered.end(); ++dit) {
-	  auto *nbb = *dit;
-	  if(nbb==bb)
-	    continue;
-	  visited.clear();
-	  seen.clear();		  
-	  if(aug_dfs<basicBlock>(nbb, bb, seen, visited, blocks, 0, 1024)) {
-	    for(auto dbb : visited) {
-	      discovered.insert(dbb);
-	    }
-	  }
+      while(true) {
+	std::set<basicBlock*> seeds = discovered;
+	augPaths(seeds, seeds, discovered, 1024);
+	if(discovered.size() == seeds.size()) {
+	  break;
 	}
       }
       break;
@@ -691,7 +741,15 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
       regionProb[nbb] += (pr * bb->edgeWeight(nbb->getEntryAddr()));
     }
   }
-  headProb = regionProb.at(head);
+  /* only a loop region is sure to branch back to its head,
+   * a baseline block or a function may not */
+  if(isBlock or isFunc) {
+    auto it = regionProb.find(head);
+    headProb = (it == regionProb.end()) ? 0.0 : it->second;
+  }
+  else {
+    headProb = regionProb.at(head);
+  }
 
   if(globals::splitCFGBBs) {
     for(auto bb : blocks) {
@@ -700,11 +758,10 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
   }
   
   for(auto bb : blocks) {
-    cfgBasicBlock *cbb = new cfgBasicBlock(bb);
+    cfgBasicBlock *cbb = newBlock(bb);
     if(bb == head) {
       cfgHead = cbb;
     }
-    cfgBlocks.push_back(cbb);
     cfgMap[bb] = cbb;
   }
   
@@ -722,20 +779,23 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
     splitBBs();
   }
   
-  /* implicit self loop when there's only one block */
-  if(cfgBlocks.size()==1) {
+  /* implicit self loop when there's only one block,
+   * a lone baseline block or function only loops if it branches to itself */
+  if(cfgBlocks.size()==1 and not(isBlock or isFunc)) {
     cfgMap[head]->addSuccessor(cfgMap[head]);
   }
 
 
   /* "compile" mips instructions into proper class */
+  cfgBlockMap.reserve(cfgBlocks.size());
   for(size_t i = 0; i < cfgBlocks.size(); i++) {
     cfgBasicBlock *cbb = cfgBlocks[i];
-    uint32_t ep = cbb->getEntryAddr();
     cbb->bindInsns(this);
-    auto it = cfgBlockMap.find(ep);
-    assert(it == cfgBlockMap.end());
-    cfgBlockMap[ep] = cbb;
+    cfgBlockMap.emplace_back(cbb->getEntryAddr(), cbb);
+  }
+  std::sort(cfgBlockMap.begin(), cfgBlockMap.end());
+  for(size_t i = 1; i < cfgBlockMap.size(); i++) {
+    assert(cfgBlockMap[i-1].first != cfgBlockMap[i].first);
   }
 
   uint32_t typeCnts[dummyprec-integerprec] = {0};
@@ -771,6 +831,15 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
     cbb->addWithInCFGEdges(this);
   }
 
+  /* host calls resume at their landing pad */
+  for(size_t i = 0; i < cfgBlocks.size(); i++) {
+    cfgBasicBlock *cbb = cfgBlocks[i];
+    uint32_t retpc = cbb->nativeCallReturn(this);
+    if(retpc) {
+      cbb->addSuccessor(findBlock(retpc));
+    }
+  }
+
   for(size_t i = 0; i < cfgBlocks.size(); i++) {
     cfgBasicBlock *cbb = cfgBlocks[i];
     if(!cbb->checkIfPlausableSuccessors()) {
@@ -792,14 +861,10 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
   while(not(likelyBlockList.empty())) {
     cfgBasicBlock *cbb = likelyBlockList.front();
     likelyBlockList.pop_front();
-    cfgBasicBlock *pbb = new cfgBasicBlock(cbb->bb, true);
+    cfgBasicBlock *pbb = newBlock(cbb->bb, true);
     pbb->bindInsns(this);
-    if(cbb->patchLikely(this, pbb)) {
-      cfgBlocks.push_back(pbb);
-    }
-    else {
-      delete pbb;
-    }
+    /* always patches, it falls back to predicting not taken */
+    cbb->patchLikely(this, pbb);
   }
   if(not(allBlocksReachable(cfgMap[head]))) {
     die();
@@ -809,22 +874,47 @@ bool regionCFG::buildCFG(std::vector<std::vector<basicBlock*> > &regions) {
   
 
   
-  bool rc = analyzeGraph();
-  if(not(rc) and globals::verbose) {
-    std::cout << "COMPILE FAILED  in analysis\n";
+  /* the cache key, taken here since compile workers
+   * never look at guest blocks */
+  headPC = head->getEntryAddr();
+  if(objCache) {
+    std::vector<uint32_t> pcs;
+    for(basicBlock *bb : blocks) {
+      pcs.push_back(bb->getEntryAddr());
+    }
+    std::sort(pcs.begin(), pcs.end());
+    blocksCRC = crc32(reinterpret_cast<uint8_t*>(pcs.data()), sizeof(uint32_t)*pcs.size());
   }
-  if(rc) {
-    generateMachineCode(globals::regionOptLevel);
-    compileTime = timestamp() - compileTime;
+
+  if(isBlock)
+    nBlockCompiles++;
+  else
+    globals::nCfgCompiles++;
+
+  /* past this point the region only reads its own cfgBasicBlocks,
+   * so analysis and ir generation can run on a compile worker */
+  if(isBlock or compileThreads.empty()) {
+    bool rc = analyzeGraph();
+    if(not(rc) and globals::verbose) {
+      std::cout << "COMPILE FAILED  in analysis\n";
+    }
+    if(rc) {
+      generateMachineCode(optLevel());
+      installMachineCode();
+    }
+    return rc;
   }
-  return rc;
+  std::unique_lock<std::mutex> lk(compileMtx);
+  pending = true;
+  nInFlight++;
+  compileQueue.push_back(this);
+  compileCV.notify_one();
+  return true;
 }
 
 bool regionCFG::analyzeGraph() {
-  entryBlock = new cfgBasicBlock(nullptr, false);
-  cfgBlocks.push_back(entryBlock);
+  entryBlock = newBlock(nullptr, false);
   entryBlock->addSuccessor(cfgHead);
-  globals::nCfgCompiles++;
   
   if(cfgBlocks.size() < 512) {
     computeDominance();
@@ -838,12 +928,6 @@ bool regionCFG::analyzeGraph() {
   computeDominanceFrontiers();
   /* search for natural loops */
   findNaturalLoops();
-  
-  /* "compile" mips instructions into proper class */
-  for(size_t i = 0, n = cfgBlocks.size(); i < n; i++) {
-    cfgBasicBlock *cbb = cfgBlocks[i];
-    cbb->bindInsns(this);
-  }
 
   /* insert phis into basicblocks */
   insertPhis();
@@ -885,6 +969,8 @@ bool regionCFG::analyzeGraph() {
   entryBlock->patchUpPhiNodes(this);
 
   
+  annotateAliasing();
+  
   std::string _errors;
   llvm::raw_string_ostream OS(_errors);
   if(llvm::verifyModule(*myModule, &OS)) {
@@ -903,19 +989,74 @@ bool regionCFG::analyzeGraph() {
   return true;
 }
 
+void regionCFG::annotateAliasing() {
+  /* one tbaa type per state field and for guest memory, whatever
+   * type it is accessed as (the fpr file is read as float, double
+   * and int) */
+  llvm::MDBuilder mdb(*Context);
+  llvm::MDNode *root = mdb.createTBAARoot("mips state");
+  auto makeTag = [&](const std::string &name) {
+    llvm::MDNode *ty = mdb.createTBAAScalarTypeNode(name, root);
+    return mdb.createTBAAStructTagNode(ty, ty, 0);
+  };
+  std::map<const llvm::Value*, llvm::MDNode*> baseTags;
+  for(const auto &p : blockArgMap) {
+    baseTags[p.second] = makeTag(p.first);
+  }
+  /* exits, ibtc and the return stack, only reached by inttoptr */
+  llvm::MDNode *hostTag = makeTag("host");
+  for(llvm::BasicBlock &lbb : *blockFunction) {
+    for(llvm::Instruction &insn : lbb) {
+      const llvm::Value *ptr = nullptr;
+      if(auto ld = llvm::dyn_cast<llvm::LoadInst>(&insn)) {
+	ptr = ld->getPointerOperand();
+      }
+      else if(auto st = llvm::dyn_cast<llvm::StoreInst>(&insn)) {
+	ptr = st->getPointerOperand();
+      }
+      else {
+	continue;
+      }
+      llvm::MDNode *tag = nullptr;
+      while(tag == nullptr) {
+	auto it = baseTags.find(ptr);
+	if(it != baseTags.end()) {
+	  tag = it->second;
+	}
+	else if(auto gep = llvm::dyn_cast<llvm::GEPOperator>(ptr)) {
+	  ptr = gep->getPointerOperand();
+	}
+	else if(auto bc = llvm::dyn_cast<llvm::BitCastOperator>(ptr)) {
+	  ptr = bc->getOperand(0);
+	}
+	else if(llvm::isa<llvm::IntToPtrInst>(ptr) or llvm::isa<llvm::ConstantExpr>(ptr)) {
+	  tag = hostTag;
+	}
+	else {
+	  break;
+	}
+      }
+      if(tag) {
+	insn.setMetadata(llvm::LLVMContext::MD_tbaa, tag);
+      }
+    }
+  }
+}
+
 void regionCFG::initLLVMAndGeneratePreamble() {
   std::vector<llvm::Type*> blockArgTypes;
   llvm::FunctionType *blockFunctionType = 0;
   std::vector<std::string> blockArgNames;
 
-  std::string tempName = "cfg_" + toStringHex(head->getEntryAddr());
+  std::string tempName = "cfg_" + toStringHex(headPC);
   std::string modName = tempName + "_module";
   std::string entryName = tempName + "_entry";
 
 #if (LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR < 9)
   Context = &(llvm::getGlobalContext());
 #else
-  Context = &globalContext;
+  /* private context, so regions can be code generated concurrently */
+  Context = new llvm::LLVMContext();
 #endif
   myIRBuilder = new llvm::IRBuilder<>(*Context);
   myModule = new llvm::Module(modName, *Context);
@@ -946,28 +1087,8 @@ void regionCFG::initLLVMAndGeneratePreamble() {
   builtinFuncts["log_bb"] = llvm::cast<llvm::Function>(cFunc);
 #endif
   
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("pc");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("gpr");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("cpr0");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("cpr1");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("fcr1");
   blockArgTypes.push_back(type_iPtr8);
-  blockArgNames.push_back("mem");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("lo");
-  blockArgTypes.push_back(type_iPtr32);
-  blockArgNames.push_back("hi");
-  blockArgTypes.push_back(type_iPtr64);
-  blockArgNames.push_back("icnt");
-  blockArgTypes.push_back(type_iPtr64);
-  blockArgNames.push_back("abortloc");
-  blockArgTypes.push_back(type_iPtr64);
-  blockArgNames.push_back("nextbb");
+  blockArgNames.push_back("state");
 
   llvm::ArrayRef<llvm::Type*> blockArgs(blockArgTypes);
   blockFunctionType = llvm::FunctionType::get(type_void,blockArgs,false);
@@ -975,17 +1096,32 @@ void regionCFG::initLLVMAndGeneratePreamble() {
 					 llvm::Function::ExternalLinkage,
 					 tempName, 
 					 myModule);
-  size_t idx = 0;
-  for (auto AI = blockFunction->arg_begin(), E = blockFunction->arg_end();
-       AI != E; ++AI) {
-    AI->setName(blockArgNames[idx]);
-    blockArgMap[blockArgNames[idx]] = &(*AI);
-    idx++;
-  }
+  llvm::Argument *vState = blockFunction->getArg(0);
+  vState->setName(blockArgNames[0]);
+  blockFunction->addParamAttr(0, llvm::Attribute::NoAlias);
 
   /* first defined block must be entry */
   entryBlock->lBB = llvm::BasicBlock::Create(*Context,tempName + "_ENTRY",blockFunction);
 
+  myIRBuilder->SetInsertPoint(entryBlock->lBB);
+  auto stateField = [&](const std::string &name, size_t offs, llvm::Type *ty) {
+    llvm::Value *gep = myIRBuilder->MakeGEP(vState, llvm::ConstantInt::get(type_int64, offs));
+    blockArgMap[name] = myIRBuilder->CreateBitCast(gep, ty, name);
+  };
+  stateField("pc", offsetof(state_t, pc), type_iPtr32);
+  stateField("gpr", offsetof(state_t, gpr), type_iPtr32);
+  stateField("lo", offsetof(state_t, lo), type_iPtr32);
+  stateField("hi", offsetof(state_t, hi), type_iPtr32);
+  stateField("cpr0", offsetof(state_t, cpr0), type_iPtr32);
+  stateField("cpr1", offsetof(state_t, cpr1), type_iPtr32);
+  stateField("fcr1", offsetof(state_t, fcr1), type_iPtr32);
+  stateField("icnt", offsetof(state_t, icnt), type_iPtr64);
+  stateField("abortloc", offsetof(state_t, abortloc), type_iPtr64);
+  blockArgMap["mem"] = myIRBuilder->CreateIntToPtr(hostAddr(guestMem), type_iPtr8);
+  if(quick or weighsExits()) {
+    generateCount(&codeEntries, 1);
+  }
+
   for(size_t i = 0; i < cfgBlocks.size(); i++) {
     if(cfgBlocks[i] == entryBlock)
       continue;
@@ -997,8 +1133,10 @@ void regionCFG::initLLVMAndGeneratePreamble() {
 
 }
 
-regionCFG::regionCFG() : execUnit() {
-  regionCFGs.insert(this);
+regionCFG::regionCFG(bool isBlock) : execUnit(), isBlock(isBlock), cancelled(false) {
+  if(not(isBlock)) {
+    regionCFGs.insert(this);
+  }
   perfectNest = true;
   isMegaRegion = false;
   innerPerfectBlock = 0;
@@ -1018,34 +1156,50 @@ regionCFG::regionCFG() : execUnit() {
   compileTime = 0.0;
   myIRBuilder=nullptr;
   myModule= nullptr;
-  myEngineBuilder=nullptr;
-  myExecEngine=nullptr;
+  jitDylib=nullptr;
   allFprTouched.resize(32, fprUseEnum::unused);
   runHistory.fill(0);
 }
 regionCFG::~regionCFG() {
-  regionCFGs.erase(regionCFGs.find(this));
+  if(not(isBlock)) {
+    regionCFGs.erase(this);
+  }
   pmap->relReference();
-  
-  for(auto cblk : cfgBlocks) {
-    delete cblk;
+  unlinkExits();
+  if(upgrade) {
+    upgrade->replaces = nullptr;
+    discard(upgrade);
+  }
+  if(replaces) {
+    replaces->upgrade = nullptr;
   }
+  for(sideExit *se : sideExits) {
+    delete se;
+  }
+  sideExits.clear();
+  
   cfgBlocks.clear();
+  blockArena.release();
     
   if(myIRBuilder)
     delete myIRBuilder; 
 
-  if(myExecEngine)
-    delete myExecEngine;
+  if(jitDylib) {
+    llvm::cantFail(jit->getExecutionSession().removeJITDylib(*jitDylib));
+  }
 
-  if(myEngineBuilder)
-    delete myEngineBuilder;
+#if ((LLVM_VERSION_MAJOR==3 && LLVM_VERSION_MINOR > 8) || LLVM_VERSION_MAJOR > 3)
+  /* frees the module too when codegen never took it */
+  if(Context)
+    delete Context;
+#endif
 }
 
  
 void regionCFG::insertPhis()  {
   /* find blocks where registers are "defined" */
   getRegDefBlocks();
+  doLiveAnalysis();
   /* if any register is written in the cfg */
   for(size_t gpr = 0; gpr < 32; gpr++) {
     if(!gprDefinitionBlocks[gpr].empty())
@@ -1063,44 +1217,49 @@ void regionCFG::insertPhis()  {
   }
   /* handle gprs */
   for(size_t gpr = 1; gpr < 32; gpr++) {
-    inducePhis<gprPhiNode>(gprDefinitionBlocks[gpr], gpr);
+    inducePhis<gprPhiNode>(blockArena, cfgBlocks, gprDefinitionBlocks[gpr], gpr, [gpr](cfgBasicBlock *b) {
+	return b->regsLiveIn.gpr[gpr];
+      });
   }
   /* handle lo-hi registers */
   for(size_t hl = 0; hl < 2; hl++) {
-    inducePhis<hiloPhiNode>(hiloDefinitionBlocks, hl);
+    inducePhis<hiloPhiNode>(blockArena, cfgBlocks, hiloDefinitionBlocks, hl, [](cfgBasicBlock *b) {
+	return b->regsLiveIn.hilo;
+      });
   }
   /* handle fprs */
   for(size_t fpr = 0; fpr < 32; fpr+=2)  {
     if(allFprTouched[fpr] == fprUseEnum::both) {
-      std::set<cfgBasicBlock*> unionedDefs;
-      for(auto bb : fprDefinitionBlocks[fpr]) {
-	unionedDefs.insert(bb);
-      }
-      for(auto bb : fprDefinitionBlocks[fpr+1]) {
-	unionedDefs.insert(bb);
-      }
+      cfgBlockSet unionedDefs = fprDefinitionBlocks[fpr];
+      unionedDefs |= fprDefinitionBlocks[fpr+1];
       fprDefinitionBlocks[fpr] = unionedDefs;
       fprDefinitionBlocks[fpr+1] = unionedDefs;
     }
   }
   
   for(size_t fpr = 0; fpr < 32; fpr++)  {
-    inducePhis<fprPhiNode>(fprDefinitionBlocks[fpr], fpr);
+    inducePhis<fprPhiNode>(blockArena, cfgBlocks, fprDefinitionBlocks[fpr], fpr, [fpr](cfgBasicBlock *b) {
+	return b->regsLiveIn.fpr[fpr];
+      });
   }
 
   
   
   /* handle cprs */
   for(size_t fcr = 0; fcr < 5; fcr++) {
-    inducePhis<fcrPhiNode>(fcrDefinitionBlocks[fcr], fcr);
+    inducePhis<fcrPhiNode>(blockArena, cfgBlocks, fcrDefinitionBlocks[fcr], fcr, [fcr](cfgBasicBlock *b) {
+	return b->regsLiveIn.fcr[fcr];
+      });
   }
   /* handle icnt */
   if(globals::countInsns) {
-    std::set<cfgBasicBlock*> allBlocks;
+    cfgBlockSet allBlocks;
     for(auto bb : cfgBlocks) {
       allBlocks.insert(bb);
     }
-    inducePhis<icntPhiNode>(allBlocks, 0);
+    inducePhis<icntPhiNode>(blockArena, cfgBlocks, allBlocks, 0, [](cfgBasicBlock *b) {
+	return true;
+      });
   }
 }
 
@@ -1147,22 +1306,21 @@ void regionCFG::computeDominance() {
   using namespace std;
   bool changed = true;
   vector<cfgBasicBlock*> preOrderVisit(cfgBlocks.size());
-  std::map<cfgBasicBlock*, size_t> blockToNumMap;
-  
-  map<cfgBasicBlock*, dynamic_bitset<>> domMap;
+  /* indexed by block id */
+  vector<bool> visited(cfgBlocks.size(), false);
+  vector<dynamic_bitset<>> domMap(cfgBlocks.size());
   
   size_t dfsNum = 0;
 
   /* use DFS to compute DFS numbers */
   function<void(cfgBasicBlock*)> dfs =[&](cfgBasicBlock* bb) {
     preOrderVisit.at(dfsNum) = bb;
-    blockToNumMap[bb] = dfsNum;
+    visited[bb->id] = true;
     dfsNum++;
-    domMap[bb] = dynamic_bitset<>(cfgBlocks.size());
-    domMap.at(bb).set();
+    domMap[bb->id] = dynamic_bitset<>(cfgBlocks.size());
+    domMap[bb->id].set();
     for(auto nbb : bb->succs) {
-      auto it = blockToNumMap.find(nbb);
-      if(it == blockToNumMap.end()) {
+      if(not(visited[nbb->id])) {
 	dfs(nbb);
       }
     }
@@ -1171,8 +1329,8 @@ void regionCFG::computeDominance() {
   /* initialize */
   dfs(entryBlock);
 
-  domMap.at(entryBlock).reset();
-  domMap.at(entryBlock)[0] = true;
+  domMap[entryBlock->id].reset();
+  domMap[entryBlock->id][0] = true;
 
   
   /* compute dominators */
@@ -1180,15 +1338,15 @@ void regionCFG::computeDominance() {
     changed = false;
     for(size_t bId=0, n=preOrderVisit.size(); bId < n; bId++) {
       cfgBasicBlock *cbb = preOrderVisit[bId];
-      dynamic_bitset<> tdd = domMap.at(cbb);
+      dynamic_bitset<> tdd = domMap[cbb->id];
       for(cfgBasicBlock *nbb : cbb->getPreds()) {
-	tdd &= domMap.at(nbb);
+	tdd &= domMap[nbb->id];
       }
       tdd[bId] = true;
       //check if changed
-      if(tdd != domMap.at(cbb)) {
+      if(tdd != domMap[cbb->id]) {
 	changed = true;
-	domMap.at(cbb) = tdd;
+	domMap[cbb->id] = tdd;
       }
     }
   }
@@ -1196,11 +1354,11 @@ void regionCFG::computeDominance() {
   
   for(size_t i = 1, n = preOrderVisit.size(); i < n; i++) {
     cfgBasicBlock *cbb = preOrderVisit[i];
-    dynamic_bitset<> &dom = domMap.at(cbb);
+    dynamic_bitset<> &dom = domMap[cbb->id];
     dom[i] = false;
     /* iterate over blocks that dominate current block */
     for(size_t j = dom.find_first(); j != dynamic_bitset<>::npos; j = dom.find_next(j)) {
-      const dynamic_bitset<> &ddom = domMap.at(preOrderVisit.at(j));
+      const dynamic_bitset<> &ddom = domMap[preOrderVisit.at(j)->id];
       for(size_t k = ddom.find_first(); k != dynamic_bitset<>::npos; k = ddom.find_next(k)) {
 	/* if j dominates k, k can not be the immediate dominator */
 	if(k!=j)
@@ -1258,8 +1416,11 @@ bool phiNode::parentInLLVM(cfgBasicBlock *b) {
 llvm::BasicBlock *phiNode::getLLVMParentBlock(cfgBasicBlock *b) {
   llvm::BasicBlock *BB = lPhi->getParent();
   llvm::BasicBlock *lbb = b->lBB;
-  if(!parentInLLVM(b) && b->has_jr_jalr() ) {
-    lbb = b->jrMap[BB];
+  if(!parentInLLVM(b)) {
+    auto it = b->jrMap.find(BB);
+    if(it != b->jrMap.end()) {
+      lbb = it->second;
+    }
   }
   return lbb;
 }
@@ -1319,7 +1480,7 @@ void icntPhiNode::addIncomingEdge(regionCFG *cfg, cfgBasicBlock *b) {
 
 
 void regionCFG::asDot() const {
-  const std::string filename = "cfg_" + toStringHex(head->getEntryAddr()) + ".dot"; 
+  const std::string filename = "cfg_" + toStringHex(headPC) + ".dot"; 
   std::ofstream out(filename);
   std::set<const basicBlock*> bbs;
   
@@ -1414,13 +1575,21 @@ llvm::BasicBlock* regionCFG::generateAbortBasicBlock(uint32_t abortpc,
 #endif
   
   llvm::Value *vNPC = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*Context),abortpc);
-  return generateAbortBasicBlock(vNPC,regTbl,cBB,lBB);
+  regionExit *link = nullptr;
+  if(globals::chainRegions and (lBB == nullptr)) {
+    link = new regionExit;
+    link->pc = abortpc;
+    exits.push_back(link);
+  }
+  return generateAbortBasicBlock(vNPC,regTbl,cBB,lBB,link);
 }
 
 llvm::BasicBlock* regionCFG::generateAbortBasicBlock(llvm::Value *abortpc, 
 						    llvmRegTables& regTbl,
 						    cfgBasicBlock *cBB,
-						    llvm::BasicBlock *lBB) {
+						    llvm::BasicBlock *lBB,
+						    regionExit *link,
+						    llvm::Value *vRetLink) {
   std::string abortName = "ABORT_" + std::to_string(uuid++);
 
   if(lBB)
@@ -1429,86 +1598,939 @@ llvm::BasicBlock* regionCFG::generateAbortBasicBlock(llvm::Value *abortpc,
   llvm::BasicBlock *saveBB = myIRBuilder->GetInsertBlock();
   llvm::BasicBlock *abortBB = llvm::BasicBlock::Create(*Context,abortName,
 						       blockFunction);
+  regSet dirty = exitRegs(cBB);
  
   myIRBuilder->SetInsertPoint(abortBB);
 
+  bool indirect = (link == nullptr) and globals::chainRegions and
+    not(llvm::isa<llvm::ConstantInt>(abortpc));
+  if(not(indirect) and (vRetLink == nullptr)) {
+    exitStub &stub = getExitStub(dirty, link != nullptr, regTbl);
+    auto vConstPC = llvm::dyn_cast<llvm::ConstantInt>(abortpc);
+    if(vConstPC and weighsExits()) {
+      sideExit *se = new sideExit;
+      se->pc = vConstPC->getZExtValue();
+      sideExits.push_back(se);
+      generateCount(&se->count, 1);
+    }
+    myIRBuilder->CreateBr(stub.lBB);
+    stub.vPC->addIncoming(abortpc, abortBB);
+    stub.vLoc->addIncoming(hostAddr(cBB->bb), abortBB);
+    if(link) {
+      stub.vLink->addIncoming(hostAddr(link, offsetof(regionExit, target)), abortBB);
+    }
+    auto incoming = [abortBB](llvm::Value *phi, llvm::Value *v) {
+      llvm::cast<llvm::PHINode>(phi)->addIncoming(v, abortBB);
+    };
+    for(size_t i = 0; i < 32; i++) {
+      if(dirty.gpr[i]) {
+	incoming(stub.regTbl.gprTbl[i], regTbl.gprTbl[i]);
+      }
+      if(dirty.fpr[i]) {
+	incoming(stub.regTbl.fprTbl[i], regTbl.fprTbl[i]);
+      }
+    }
+    for(size_t i = 0; i < 5; i++) {
+      if(dirty.fcr[i]) {
+	incoming(stub.regTbl.fcrTbl[i], regTbl.fcrTbl[i]);
+      }
+    }
+    if(dirty.hilo) {
+      incoming(stub.regTbl.hiloTbl[0], regTbl.hiloTbl[0]);
+      incoming(stub.regTbl.hiloTbl[1], regTbl.hiloTbl[1]);
+    }
+    if(globals::countInsns) {
+      incoming(stub.regTbl.iCnt, regTbl.iCnt);
+    }
+    myIRBuilder->SetInsertPoint(saveBB);
+    return abortBB;
+  }
+
   //flush PC
   llvm::Value *offs = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*Context),0);
   llvm::Value *gep = myIRBuilder->MakeGEP(blockArgMap["pc"], offs);
   llvm::Value *vPtr = myIRBuilder->CreateBitCast(gep, llvm::Type::getInt32PtrTy(*Context));
   myIRBuilder->CreateStore(abortpc,vPtr);
 
-  llvm::Value *vNPC = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*Context),(uint64_t)(cBB->bb));
+  llvm::Value *vNPC = hostAddr(cBB->bb);
   gep = myIRBuilder->MakeGEP(blockArgMap["abortloc"], offs);
   vPtr = myIRBuilder->CreateBitCast(gep, llvm::Type::getInt64PtrTy(*Context));
   myIRBuilder->CreateStore(vNPC,vPtr);
 
-  /* we can't statically determine the next basic block */
-  llvm::Value *vNBB = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*Context),(uint64_t)nullptr);
-  gep = myIRBuilder->MakeGEP(blockArgMap["nextbb"], offs);
-  vPtr = myIRBuilder->CreateBitCast(gep, llvm::Type::getInt64PtrTy(*Context));
-  myIRBuilder->CreateStore(vNBB,vPtr);
 
 
+  generateStateFlush(regTbl, dirty);
 
+  regionExit *site = nullptr;
+  if(indirect) {
+    site = new regionExit;
+    indirectExits.push_back(site);
+  }
+
+  if(site) {
+    /* indirect exit : check a predicted return, the target
+     * cached at this site, then the global indirect branch table */
+    llvm::BasicBlock *retBB = llvm::BasicBlock::Create(*Context,abortName + "_RET",
+						       blockFunction);
+    if(vRetLink) {
+      llvm::BasicBlock *retChainBB = llvm::BasicBlock::Create(*Context,abortName + "_RAS",
+							      blockFunction);
+      llvm::BasicBlock *retHitBB = llvm::BasicBlock::Create(*Context,abortName + "_RASHIT",
+							    blockFunction);
+      llvm::BasicBlock *retLoadBB = llvm::BasicBlock::Create(*Context,abortName + "_RASLD",
+							     blockFunction);
+      llvm::BasicBlock *siteBB = llvm::BasicBlock::Create(*Context,abortName + "_SITE",
+							  blockFunction);
+      llvm::Value *vZ = llvm::ConstantInt::get(type_int64,0);
+      myIRBuilder->CreateCondBr(myIRBuilder->CreateICmpNE(vRetLink, vZ), retHitBB, siteBB);
+      /* returning to a host call, unwind to the caller */
+      myIRBuilder->SetInsertPoint(retHitBB);
+      llvm::Value *vNative = hostAddr(&nativeReturn, offsetof(regionExit, target));
+      myIRBuilder->CreateCondBr(myIRBuilder->CreateICmpEQ(vRetLink, vNative), retBB, retLoadBB);
+      myIRBuilder->SetInsertPoint(retLoadBB);
+      llvm::Value *vRetTarget = myIRBuilder->MakeLoad(myIRBuilder->CreateIntToPtr(vRetLink, type_iPtr64), "");
+      myIRBuilder->CreateCondBr(myIRBuilder->CreateICmpNE(vRetTarget, vZ), retChainBB, siteBB);
+      myIRBuilder->SetInsertPoint(retChainBB);
+      generateChainCall(vRetTarget);
+      myIRBuilder->SetInsertPoint(siteBB);
+    }
+    llvm::BasicBlock *lookupBB = llvm::BasicBlock::Create(*Context,abortName + "_IBTC",
+							  blockFunction);
+    llvm::BasicBlock *fillBB = llvm::BasicBlock::Create(*Context,abortName + "_FILL",
+							blockFunction);
+    llvm::BasicBlock *chainBB = llvm::BasicBlock::Create(*Context,abortName + "_CHAIN",
+							 blockFunction);
+    llvm::Value *vZ = llvm::ConstantInt::get(type_int64,0);
+    llvm::Value *vSitePC = loadExitField(site, offsetof(regionExit, pc), type_int32);
+    llvm::Value *vSiteTarget = loadExitField(site, offsetof(regionExit, target), type_int64);
+    llvm::Value *vSiteHit = myIRBuilder->CreateAnd(myIRBuilder->CreateICmpEQ(vSitePC, abortpc),
+						   myIRBuilder->CreateICmpNE(vSiteTarget, vZ));
+    llvm::BasicBlock *siteBB = myIRBuilder->GetInsertBlock();
+    myIRBuilder->CreateCondBr(vSiteHit, chainBB, lookupBB);
+
+    myIRBuilder->SetInsertPoint(lookupBB);
+    llvm::Value *vIdx = myIRBuilder->CreateAnd(myIRBuilder->CreateLShr(abortpc, 2),
+					       llvm::ConstantInt::get(type_int32, ibtcLen-1));
+    vIdx = myIRBuilder->CreateMul(myIRBuilder->CreateZExt(vIdx, type_int64),
+				  llvm::ConstantInt::get(type_int64, sizeof(regionExit)));
+    llvm::Value *vEntry = myIRBuilder->CreateAdd(vIdx, hostAddr(ibtc.data()));
+    llvm::Value *vPCPtr = myIRBuilder->CreateIntToPtr(
+      myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64, offsetof(regionExit, pc))),
+      type_iPtr32);
+    llvm::Value *vTgtPtr = myIRBuilder->CreateIntToPtr(
+      myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64, offsetof(regionExit, target))),
+      type_iPtr64);
+    llvm::Value *vEntryPC = myIRBuilder->MakeLoad(vPCPtr, "");
+    llvm::Value *vEntryTarget = myIRBuilder->MakeLoad(vTgtPtr, "");
+    llvm::Value *vEntryHit = myIRBuilder->CreateAnd(myIRBuilder->CreateICmpEQ(vEntryPC, abortpc),
+						    myIRBuilder->CreateICmpNE(vEntryTarget, vZ));
+    myIRBuilder->CreateCondBr(vEntryHit, fillBB, retBB);
+
+    myIRBuilder->SetInsertPoint(fillBB);
+    myIRBuilder->CreateStore(abortpc, myIRBuilder->CreateIntToPtr(
+      hostAddr(site, offsetof(regionExit, pc)), type_iPtr32));
+    myIRBuilder->CreateStore(vEntryTarget, myIRBuilder->CreateIntToPtr(
+      hostAddr(site, offsetof(regionExit, target)), type_iPtr64));
+    myIRBuilder->CreateBr(chainBB);
+
+    myIRBuilder->SetInsertPoint(chainBB);
+    llvm::PHINode *vTarget = myIRBuilder->CreatePHI(type_int64, 2);
+    vTarget->addIncoming(vSiteTarget, siteBB);
+    vTarget->addIncoming(vEntryTarget, fillBB);
+    generateChainCall(vTarget);
+    myIRBuilder->SetInsertPoint(retBB);
+  }
+  
+  myIRBuilder->CreateRetVoid();  
+  myIRBuilder->SetInsertPoint(saveBB);
+  return abortBB;
+}
+
+regionCFG::exitStub &regionCFG::getExitStub(const regSet &dirty, bool chained,
+					     llvmRegTables &regTbl) {
+  exitStub &stub = exitStubs[std::make_pair(dirty, chained)];
+  if(stub.lBB) {
+    return stub;
+  }
+  llvm::BasicBlock *saveBB = myIRBuilder->GetInsertBlock();
+  std::string stubName = "EXIT_" + std::to_string(uuid++);
+  stub.lBB = llvm::BasicBlock::Create(*Context, stubName, blockFunction);
+  myIRBuilder->SetInsertPoint(stub.lBB);
+  stub.regTbl.copy(llvmRegTables(this));
+  stub.vPC = myIRBuilder->CreatePHI(type_int32, 2);
+  stub.vLoc = myIRBuilder->CreatePHI(type_int64, 2);
+  if(chained) {
+    stub.vLink = myIRBuilder->CreatePHI(type_int64, 2);
+  }
   for(size_t i = 0; i < 32; i++) {
-    if(!gprDefinitionBlocks[i].empty())
+    if(dirty.gpr[i]) {
+      stub.regTbl.gprTbl[i] = myIRBuilder->CreatePHI(type_int32, 2);
+    }
+    if(dirty.fpr[i]) {
+      stub.regTbl.fprTbl[i] = myIRBuilder->CreatePHI(regTbl.fprTbl[i]->getType(), 2);
+    }
+  }
+  for(size_t i = 0; i < 5; i++) {
+    if(dirty.fcr[i]) {
+      stub.regTbl.fcrTbl[i] = myIRBuilder->CreatePHI(type_int32, 2);
+    }
+  }
+  if(dirty.hilo) {
+    stub.regTbl.hiloTbl[0] = myIRBuilder->CreatePHI(type_int32, 2);
+    stub.regTbl.hiloTbl[1] = myIRBuilder->CreatePHI(type_int32, 2);
+  }
+  if(globals::countInsns) {
+    stub.regTbl.iCnt = myIRBuilder->CreatePHI(type_int64, 2);
+  }
+
+  llvm::Value *offs = llvm::ConstantInt::get(type_int32,0);
+  myIRBuilder->CreateStore(stub.vPC, myIRBuilder->MakeGEP(blockArgMap["pc"], offs));
+  myIRBuilder->CreateStore(stub.vLoc, myIRBuilder->MakeGEP(blockArgMap["abortloc"], offs));
+  generateStateFlush(stub.regTbl, dirty);
+
+  if(chained) {
+    /* state is in memory, so a linked exit can enter the
+     * target's code in place of returning to the dispatcher */
+    llvm::BasicBlock *chainBB = llvm::BasicBlock::Create(*Context,stubName + "_CHAIN",
+							 blockFunction);
+    llvm::BasicBlock *retBB = llvm::BasicBlock::Create(*Context,stubName + "_RET",
+						       blockFunction);
+    llvm::Value *vTarget = myIRBuilder->MakeLoad(myIRBuilder->CreateIntToPtr(stub.vLink, type_iPtr64), "");
+    llvm::Value *vZ = llvm::ConstantInt::get(type_int64,0);
+    myIRBuilder->CreateCondBr(myIRBuilder->CreateICmpNE(vTarget, vZ), chainBB, retBB);
+
+    myIRBuilder->SetInsertPoint(chainBB);
+    generateChainCall(vTarget);
+    myIRBuilder->SetInsertPoint(retBB);
+  }
+  myIRBuilder->CreateRetVoid();
+  myIRBuilder->SetInsertPoint(saveBB);
+  return stub;
+}
+
+void regionCFG::generateStateFlush(llvmRegTables &regTbl, const regSet &dirty) {
+  for(size_t i = 0; i < 32; i++) {
+    if(dirty.gpr[i])
       regTbl.storeGPR(i);
   }
   
-  if(!hiloDefinitionBlocks.empty()) {
+  if(dirty.hilo) {
     regTbl.storeHiLo(0);
     regTbl.storeHiLo(1);
   }
 
   for(size_t i = 0; i < 32; i++) {
-    if(!fprDefinitionBlocks[i].empty())
+    if(dirty.fpr[i])
       regTbl.storeFPR(i);
   }
   
   for(size_t i = 0; i < 5; i++) {
-    if(!fcrDefinitionBlocks[i].empty())
+    if(dirty.fcr[i])
       regTbl.storeFCR(i);
   }
 
   if(globals::countInsns) {
     regTbl.storeIcnt();
   }
-  
-  myIRBuilder->CreateRetVoid();  
-  myIRBuilder->SetInsertPoint(saveBB);
-  return abortBB;
 }
 
+llvm::Value *regionCFG::loadExitField(regionExit *e, size_t offs, llvm::Type *ty) {
+  llvm::Value *vAddr = hostAddr(e, offs);
+  llvm::Value *vPtr = myIRBuilder->CreateIntToPtr(vAddr, ty->getPointerTo());
+  return myIRBuilder->MakeLoad(vPtr, "");
+}
+
+llvm::Value *regionCFG::hostAddr(const void *p, size_t offs) {
+  llvm::Constant *&g = hostGlobals[p];
+  if(g == nullptr) {
+    /* opaque, so llvm makes no assumptions about its extent */
+    std::string name = "__host_" + std::to_string(hostSyms.size());
+    llvm::Type *ty = llvm::StructType::create(*Context);
+    g = llvm::ConstantExpr::getPtrToInt(
+      new llvm::GlobalVariable(*myModule, ty, false, llvm::GlobalValue::ExternalLinkage,
+			       nullptr, name), type_int64);
+    hostSyms[name] = reinterpret_cast<uint64_t>(p);
+  }
+  return llvm::ConstantExpr::getAdd(g, llvm::ConstantInt::get(type_int64, offs));
+}
+
+void regionCFG::generateCount(uint64_t *cnt, uint64_t amt) {
+  llvm::Value *vCntPtr = myIRBuilder->CreateIntToPtr(hostAddr(cnt), type_iPtr64);
+  llvm::Value *vCnt = myIRBuilder->MakeLoad(vCntPtr, "");
+  myIRBuilder->CreateStore(myIRBuilder->CreateAdd(vCnt, llvm::ConstantInt::get(type_int64, amt)),
+			   vCntPtr);
+}
 
+void regionCFG::generateChainCall(llvm::Value *vTarget) {
+  llvm::FunctionType *fType = blockFunction->getFunctionType();
+  llvm::Value *vFunc = myIRBuilder->CreateIntToPtr(vTarget, fType->getPointerTo());
+  std::vector<llvm::Value*> args;
+  for(auto &a : blockFunction->args()) {
+    args.push_back(&a);
+  }
+  llvm::CallInst *chainCall = myIRBuilder->CreateCall(fType, vFunc, args);
+  chainCall->setTailCallKind(llvm::CallInst::TCK_MustTail);
+  myIRBuilder->CreateRetVoid();
+}
 
+void regionCFG::generateRASPush(uint32_t retpc, bool native) {
+  if(not(globals::chainRegions)) {
+    return;
+  }
+  /* the return lands on an ordinary chained exit slot,
+   * unless a host call is waiting for it */
+  regionExit *link = &nativeReturn;
+  if(not(native)) {
+    link = new regionExit;
+    link->pc = retpc;
+    exits.push_back(link);
+  }
+  llvm::Value *vTopPtr = myIRBuilder->CreateIntToPtr(hostAddr(&rasTop), type_iPtr32);
+  llvm::Value *vTop = myIRBuilder->MakeLoad(vTopPtr, "");
+  vTop = myIRBuilder->CreateAnd(myIRBuilder->CreateAdd(vTop, llvm::ConstantInt::get(type_int32,1)),
+				llvm::ConstantInt::get(type_int32,rasLen-1));
+  myIRBuilder->CreateStore(vTop, vTopPtr);
+  llvm::Value *vEntry = myIRBuilder->CreateAdd(
+    myIRBuilder->CreateMul(myIRBuilder->CreateZExt(vTop, type_int64),
+			   llvm::ConstantInt::get(type_int64,sizeof(rasEntry))),
+    hostAddr(ras.data()));
+  llvm::Value *vLinkPtr = myIRBuilder->CreateIntToPtr(
+    myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64,offsetof(rasEntry,link))),
+    type_iPtr64);
+  llvm::Value *vPCPtr = myIRBuilder->CreateIntToPtr(
+    myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64,offsetof(rasEntry,pc))),
+    type_iPtr32);
+  myIRBuilder->CreateStore(hostAddr(link, offsetof(regionExit, target)), vLinkPtr);
+  myIRBuilder->CreateStore(llvm::ConstantInt::get(type_int32,retpc), vPCPtr);
+}
 
+void regionCFG::generateNativeCall(cfgBasicBlock *cBB, llvmRegTables &regTbl,
+				   uint32_t callee, uint32_t retpc) {
+  std::string callName = "CALL_" + std::to_string(uuid++);
+  llvm::BasicBlock *landBB = cBB->getSuccLLVMBasicBlock(retpc);
+  assert(landBB != nullptr);
+  /* callee entry, filled in by linkExits like any other exit */
+  regionExit *link = new regionExit;
+  link->pc = callee;
+  exits.push_back(link);
+
+  llvm::Value *vNPC = llvm::ConstantInt::get(type_int32, callee);
+  llvm::Value *vTarget = loadExitField(link, offsetof(regionExit, target), type_int64);
+  llvm::Value *vDepthPtr = myIRBuilder->CreateIntToPtr(hostAddr(&callDepth), type_iPtr32);
+  llvm::Value *vDepth = myIRBuilder->MakeLoad(vDepthPtr, "");
+  llvm::Value *vCall = myIRBuilder->CreateAnd(
+    myIRBuilder->CreateICmpNE(vTarget, llvm::ConstantInt::get(type_int64,0)),
+    myIRBuilder->CreateICmpULT(vDepth, llvm::ConstantInt::get(type_int32,maxCallDepth)));
+  /* uncompiled callee or too deep a host stack, leave through the exit */
+  llvm::BasicBlock *abortBB = generateAbortBasicBlock(vNPC, regTbl, cBB, nullptr, link);
+  llvm::BasicBlock *callBB = llvm::BasicBlock::Create(*Context, callName, blockFunction);
+  llvm::BasicBlock *leaveBB = llvm::BasicBlock::Create(*Context, callName + "_LEAVE", blockFunction);
+  llvm::BasicBlock *contBB = llvm::BasicBlock::Create(*Context, callName + "_CONT", blockFunction);
+  myIRBuilder->CreateCondBr(vCall, callBB, abortBB);
+
+  myIRBuilder->SetInsertPoint(callBB);
+  llvm::Value *gep = myIRBuilder->MakeGEP(blockArgMap["pc"], llvm::ConstantInt::get(type_int32,0));
+  myIRBuilder->CreateStore(vNPC, gep);
+  generateStateFlush(regTbl, exitRegs(cBB));
+  generateRASPush(retpc, true);
+  myIRBuilder->CreateStore(myIRBuilder->CreateAdd(vDepth, llvm::ConstantInt::get(type_int32,1)),
+			   vDepthPtr);
+  llvm::FunctionType *fType = blockFunction->getFunctionType();
+  std::vector<llvm::Value*> args;
+  for(auto &a : blockFunction->args()) {
+    args.push_back(&a);
+  }
+  myIRBuilder->CreateCall(fType, myIRBuilder->CreateIntToPtr(vTarget, fType->getPointerTo()), args);
+  myIRBuilder->CreateStore(vDepth, vDepthPtr);
+  /* the callee left through some other exit, so must we */
+  llvm::Value *vPC = myIRBuilder->MakeLoad(gep, "");
+  myIRBuilder->CreateCondBr(myIRBuilder->CreateICmpEQ(vPC, llvm::ConstantInt::get(type_int32,retpc)),
+			    contBB, leaveBB);
+  myIRBuilder->SetInsertPoint(leaveBB);
+  myIRBuilder->CreateRetVoid();
+
+  /* guest state is in memory again, pick it back up */
+  myIRBuilder->SetInsertPoint(contBB);
+  for(size_t i = 1; i < 32; i++) {
+    if(regTbl.gprTbl[i]) {
+      regTbl.gprTbl[i] = nullptr;
+      regTbl.loadGPR(i);
+    }
+  }
+  for(size_t i = 0; i < 32; i++) {
+    if(regTbl.fprTbl[i]) {
+      regTbl.fprTbl[i] = nullptr;
+      regTbl.loadFPR(i);
+    }
+  }
+  for(size_t i = 0; i < 2; i++) {
+    if(regTbl.hiloTbl[i]) {
+      regTbl.hiloTbl[i] = nullptr;
+      regTbl.loadHiLo(i);
+    }
+  }
+  for(size_t i = 0; i < 5; i++) {
+    if(regTbl.fcrTbl[i]) {
+      regTbl.fcrTbl[i] = nullptr;
+      regTbl.loadFCR(i);
+    }
+  }
+  if(globals::countInsns) {
+    regTbl.initIcnt();
+  }
+  myIRBuilder->CreateBr(landBB);
+  cBB->jrMap[landBB] = contBB;
+}
 
+llvm::Value *regionCFG::generateRASPop(llvm::Value *vNPC) {
+  if(not(globals::chainRegions)) {
+    return nullptr;
+  }
+  llvm::Value *vTopPtr = myIRBuilder->CreateIntToPtr(hostAddr(&rasTop), type_iPtr32);
+  llvm::Value *vTop = myIRBuilder->MakeLoad(vTopPtr, "");
+  llvm::Value *vEntry = myIRBuilder->CreateAdd(
+    myIRBuilder->CreateMul(myIRBuilder->CreateZExt(vTop, type_int64),
+			   llvm::ConstantInt::get(type_int64,sizeof(rasEntry))),
+    hostAddr(ras.data()));
+  llvm::Value *vLinkPtr = myIRBuilder->CreateIntToPtr(
+    myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64,offsetof(rasEntry,link))),
+    type_iPtr64);
+  llvm::Value *vPCPtr = myIRBuilder->CreateIntToPtr(
+    myIRBuilder->CreateAdd(vEntry, llvm::ConstantInt::get(type_int64,offsetof(rasEntry,pc))),
+    type_iPtr32);
+  llvm::Value *vLink = myIRBuilder->MakeLoad(vLinkPtr, "");
+  llvm::Value *vPC = myIRBuilder->MakeLoad(vPCPtr, "");
+  vTop = myIRBuilder->CreateAnd(myIRBuilder->CreateSub(vTop, llvm::ConstantInt::get(type_int32,1)),
+				llvm::ConstantInt::get(type_int32,rasLen-1));
+  myIRBuilder->CreateStore(vTop, vTopPtr);
+  /* link slot of the predicted return, zero on a mismatch */
+  return myIRBuilder->CreateSelect(myIRBuilder->CreateICmpEQ(vPC, vNPC), vLink,
+				   llvm::ConstantInt::get(type_int64,0));
+}
 
+void regionCFG::ibtcInsert(uint32_t pc, compiledCFG target) {
+  regionExit &e = ibtc[(pc>>2) & (ibtcLen-1)];
+  e.pc = pc;
+  e.target = target;
+}
 
-void regionCFG::generateMachineCode( llvm::CodeGenOpt::Level optLevel){
-  std::string errStr;
-  myEngineBuilder = new llvm::EngineBuilder(std::unique_ptr<llvm::Module>(myModule));
-  myEngineBuilder->setOptLevel(optLevel);
-  myEngineBuilder->setErrorStr(&errStr);
-#ifdef __amd64_
-  myEngineBuilder->setMCPU("corei7");
-#endif
-  myExecEngine = myEngineBuilder->create();
+/* a chained exit jumps straight to other compiled code, so the
+ * dispatcher and with it the region finder's update(), collection
+ * and the per unit profile see only transfers through unlinked
+ * exits. hot chained code therefore stops forming new regions,
+ * --chain 0 keeps every transfer visible */
+void regionCFG::linkExits() {
+  for(regionExit *e : indirectExits) {
+    indirectSites.insert(e);
+  }
+  for(regionExit *e : exits) {
+    exitsByPC.insert(std::make_pair(e->pc, e));
+    auto it = entryPoints.find(e->pc);
+    if(it != entryPoints.end()) {
+      e->target = it->second->codeBits;
+      nChainedExits++;
+    }
+  }
+  uint32_t pc = head->getEntryAddr();
+  auto it = entryPoints.find(pc);
+  /* a region takes over exits from baseline code at its head */
+  if(it != entryPoints.end() and isBlock) {
+    return;
+  }
+  entryPoints[pc] = this;
+  auto r = exitsByPC.equal_range(pc);
+  for(auto eit = r.first; eit != r.second; ++eit) {
+    if(eit->second->target == nullptr) {
+      nChainedExits++;
+    }
+    eit->second->target = codeBits;
+  }
+  ibtcInsert(pc, codeBits);
+  for(regionExit *e : indirectSites) {
+    if(e->pc == pc and e->target) {
+      e->target = codeBits;
+    }
+  }
+}
+
+void regionCFG::unlinkExits() {
+  if(head) {
+    uint32_t pc = head->getEntryAddr();
+    auto it = entryPoints.find(pc);
+    if(it != entryPoints.end() and it->second == this) {
+      /* baseline code at the head gets its exits back */
+      regionCFG *blk = head->blockCplr;
+      compiledCFG target = nullptr;
+      if(blk and (blk != this) and blk->codeBits) {
+	it->second = blk;
+	target = blk->codeBits;
+      }
+      else {
+	entryPoints.erase(it);
+      }
+      auto r = exitsByPC.equal_range(pc);
+      for(auto eit = r.first; eit != r.second; ++eit) {
+	eit->second->target = target;
+      }
+      regionExit &e = ibtc[(pc>>2) & (ibtcLen-1)];
+      if(e.target == codeBits) {
+	e.target = target;
+      }
+      for(regionExit *ie : indirectSites) {
+	if(ie->target == codeBits) {
+	  ie->target = target;
+	}
+      }
+    }
+  }
+  for(regionExit *e : indirectExits) {
+    indirectSites.erase(e);
+    delete e;
+  }
+  indirectExits.clear();
+  /* return stack entries may point at exits freed below */
+  if(not(exits.empty())) {
+    ras.fill(rasEntry{0,0});
+  }
+  for(regionExit *e : exits) {
+    auto r = exitsByPC.equal_range(e->pc);
+    for(auto eit = r.first; eit != r.second; ++eit) {
+      if(eit->second == e) {
+	exitsByPC.erase(eit);
+	break;
+      }
+    }
+    delete e;
+  }
+  exits.clear();
+}
+
+
+
+
+
+
+
+/* module flag carrying the codegen level a region asked for */
+static const char *optLevelFlag = "dbt.optlevel";
+
+/* codegen at the region's own opt level, asking the
+ * translation cache before running the backend */
+class regionCompiler : public llvm::orc::IRCompileLayer::IRCompiler {
+private:
+  llvm::orc::JITTargetMachineBuilder jtmb;
+public:
+  regionCompiler(llvm::orc::JITTargetMachineBuilder jtmb) :
+    IRCompiler(llvm::orc::irManglingOptionsFromTargetOptions(jtmb.getOptions())),
+    jtmb(std::move(jtmb)) {}
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(llvm::Module &M) override {
+    llvm::orc::JITTargetMachineBuilder b = jtmb;
+    auto *level = llvm::mdconst::extract_or_null<llvm::ConstantInt>(M.getModuleFlag(optLevelFlag));
+    if(level) {
+      b.setCodeGenOptLevel(static_cast<llvm::CodeGenOpt::Level>(level->getZExtValue()));
+    }
+    auto tm = b.createTargetMachine();
+    if(not(tm)) {
+      return tm.takeError();
+    }
+    return llvm::orc::SimpleCompiler(**tm, regionCFG::objCache)(M);
+  }
+};
+
+/* the host cpu and its features (movbe, bmi, avx2..), read once */
+static const std::vector<std::string> &hostFeatures() {
+  static const std::vector<std::string> features = [] {
+    std::vector<std::string> fv;
+    llvm::StringMap<bool> hf;
+    if(llvm::sys::getHostCPUFeatures(hf)) {
+      for(auto &f : hf) {
+	fv.push_back((f.second ? "+" : "-") + f.first().str());
+      }
+    }
+    return fv;
+  }();
+  return features;
+}
+
+llvm::orc::JITTargetMachineBuilder regionCFG::hostTarget() {
+  llvm::orc::JITTargetMachineBuilder jtmb(llvm::Triple(llvm::sys::getProcessTriple()));
+  if(globals::jitCPU == "host") {
+    jtmb.setCPU(llvm::sys::getHostCPUName().str());
+    jtmb.addFeatures(hostFeatures());
+  }
+  else {
+    jtmb.setCPU(globals::jitCPU);
+  }
+  /* overrides, e.g "-avx512f" for a mixed fleet */
+  llvm::SmallVector<llvm::StringRef, 8> extra;
+  llvm::StringRef(globals::jitFeatures).split(extra, ',', -1, false);
+  for(llvm::StringRef f : extra) {
+    jtmb.getFeatures().AddFeature(f.trim());
+  }
+  return jtmb;
+}
+
+std::string regionCFG::checkTarget() {
+  llvm::orc::JITTargetMachineBuilder jtmb = hostTarget();
+  auto tm = jtmb.createTargetMachine();
+  if(not(tm)) {
+    return llvm::toString(tm.takeError());
+  }
+  if(not((*tm)->getMCSubtargetInfo()->isCPUStringValid(jtmb.getCPU()))) {
+    return "unknown jit cpu " + jtmb.getCPU();
+  }
+  return "";
+}
 
+void regionCFG::startJIT() {
+  auto j = llvm::orc::LLJITBuilder()
+    .setJITTargetMachineBuilder(hostTarget())
+    .setObjectLinkingLayerCreator([](llvm::orc::ExecutionSession &ES, const llvm::Triple &) {
+	auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(ES, []() ->
+	  std::unique_ptr<llvm::RuntimeDyld::MemoryManager> {
+	    if(codeHeap::enabled()) {
+	      return std::make_unique<codeHeapMM>();
+	    }
+	    return std::make_unique<llvm::SectionMemoryManager>();
+	  });
 #ifdef USE_VTUNE
-  llvm::JITEventListener *vtuneProfiler = 
-    llvm::JITEventListener::createIntelJITEventListener();
-  myExecEngine->RegisterJITEventListener(vtuneProfiler);
+	layer->registerJITEventListener(*llvm::JITEventListener::createIntelJITEventListener());
 #endif
-  myExecEngine->finalizeObject();
-  codeBits = (compiledCFG)myExecEngine->getPointerToFunction(blockFunction);
-  std::string headname = "cfg_";
-  if(perfectNest) {
+	return llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>>(std::move(layer));
+      })
+    .setCompileFunctionCreator([](llvm::orc::JITTargetMachineBuilder jtmb) {
+	return llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>>(
+	  std::make_unique<regionCompiler>(std::move(jtmb)));
+      })
+    /* no static initializers in region code */
+    .setPlatformSetUp(llvm::orc::setUpInactivePlatform)
+    .create();
+  if(not(j)) {
+    llvm::logAllUnhandledErrors(j.takeError(), llvm::errs(), "jit : ");
+    die();
+  }
+  jit = std::move(*j);
+  /* builtins and libm calls resolve against the simulator */
+  auto gen = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+    jit->getDataLayout().getGlobalPrefix());
+  jit->getMainJITDylib().addGenerator(llvm::cantFail(std::move(gen)));
+}
+
+void regionCFG::stopJIT() {
+  jit.reset();
+}
+
+std::string regionCFG::checkPasses(const std::string &passes) {
+  llvm::PassBuilder pb;
+  llvm::ModulePassManager mpm;
+  if(auto err = pb.parsePassPipeline(mpm, passes)) {
+    return llvm::toString(std::move(err));
+  }
+  return "";
+}
+
+void regionCFG::optimizeModule(llvm::CodeGenOpt::Level optLevel) {
+  double t = timestamp();
+  irInsnsIn = myModule->getInstructionCount();
+  auto tm = hostTarget().setCodeGenOptLevel(optLevel).createTargetMachine();
+  if(not(tm)) {
+    llvm::logAllUnhandledErrors(tm.takeError(), llvm::errs(), "jit : ");
+    die();
+  }
+  myModule->setDataLayout((*tm)->createDataLayout());
+  myModule->setTargetTriple((*tm)->getTargetTriple().str());
+
+  /* cost models (unrolling, lsr) want the real target */
+  llvm::PassBuilder pb(tm->get());
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+  llvm::ModulePassManager mpm;
+  llvm::cantFail(pb.parsePassPipeline(mpm, quick ? quickPasses : globals::irPasses));
+  mpm.run(*myModule, mam);
+
+  irInsnsOut = myModule->getInstructionCount();
+  optTime = timestamp() - t;
+}
+
+void regionCFG::generateMachineCode( llvm::CodeGenOpt::Level optLevel){
+  if(objCache) {
+    objCache->setKey(*myModule, headPC, blocksCRC, optLevel, quick);
+  }
+  myModule->addModuleFlag(llvm::Module::Warning, optLevelFlag, static_cast<uint32_t>(optLevel));
+  /* the baseline tier and cached objects skip the ir passes */
+  if(not(isBlock) and not(globals::irPasses.empty()) and
+     not(objCache and objCache->has(*myModule))) {
+    optimizeModule(optLevel);
+  }
+
+  /* a private dylib, so region symbol names never collide */
+  llvm::orc::ExecutionSession &ES = jit->getExecutionSession();
+  jitDylib = &ES.createBareJITDylib(blockFunction->getName().str() + "_" +
+				    toStringHex(reinterpret_cast<uint64_t>(this)));
+  if(not(hostSyms.empty())) {
+    llvm::orc::SymbolMap syms;
+    for(const auto &hs : hostSyms) {
+      syms[jit->mangleAndIntern(hs.first)] =
+	llvm::JITEvaluatedSymbol(hs.second, llvm::JITSymbolFlags::Exported);
+    }
+    llvm::cantFail(jitDylib->define(llvm::orc::absoluteSymbols(std::move(syms))));
+  }
+  jitDylib->addToLinkOrder(jit->getMainJITDylib());
+
+  /* the jit owns the module and its context from here on */
+  if(globals::dumpIR or globals::report) {
+    llvm::raw_string_ostream bcOut(bitcode);
+    llvm::WriteBitcodeToFile(*myModule, bcOut);
+    bcOut.flush();
+  }
+  std::string fName = blockFunction->getName().str();
+  delete myIRBuilder;
+  myIRBuilder = nullptr;
+  llvm::cantFail(jit->addIRModule(*jitDylib, llvm::orc::ThreadSafeModule(
+				    std::unique_ptr<llvm::Module>(myModule),
+				    std::unique_ptr<llvm::LLVMContext>(Context))));
+  myModule = nullptr;
+  blockFunction = nullptr;
+  Context = nullptr;
+
+  codeHeap::cold = isBlock or quick;
+  auto sym = jit->lookup(*jitDylib, fName);
+  if(not(sym)) {
+    llvm::logAllUnhandledErrors(sym.takeError(), llvm::errs(), "jit : ");
+    die();
+  }
+  codeBits = reinterpret_cast<compiledCFG>(sym->getAddress());
+  compileTime = timestamp() - compileTime;
+}
+
+void regionCFG::installMachineCode() {
+  std::string headname = isBlock ? "blk_" : "cfg_";
+  if(perfectNest and not(isBlock)) {
     headname += "perfectNest_";
   }
   headname += toStringHex(cfgHead->getEntryAddr());
   pmap->addEntry((uint64_t)codeBits, 1<<12, headname);
+  linkExits();
+  if(replaces) {
+    promote();
+  }
+}
+
+llvm::CodeGenOpt::Level regionCFG::optLevel() const {
+  return (isBlock or quick) ? llvm::CodeGenOpt::None : globals::regionOptLevel;
+}
+
+/* builds a copy of the region from rr, at full optimization, that
+ * replaces it once installed. compiled inline, that frees this
+ * region before returning */
+void regionCFG::recompile(std::vector<std::vector<basicBlock*>> &rr, bool reform) {
+  regionCFG *opt = isFunc ? new funcCFG() : new regionCFG();
+  opt->replaces = this;
+  opt->reformed = reform;
+  upgrade = opt;
+  if(not(opt->buildCFG(rr))) {
+    delete opt;
+  }
+}
+
+void regionCFG::recompileOptimized() {
+  tierUpTried = true;
+  std::vector<std::vector<basicBlock*>> rr(1);
+  rr[0].push_back(head);
+  for(basicBlock *bb : blocks) {
+    if(bb != head) {
+      rr[0].push_back(bb);
+    }
+  }
+  recompile(rr, false);
+}
+
+/* the trace missed a path that hot exit takes, rebuild the region
+ * with the path from the exit's target back into the region */
+void regionCFG::reformFromExits() {
+  /* exits are counted however the region was entered,
+   * so weigh them against entries counted the same way */
+  uint64_t window = codeEntries - reformBase;
+  reformBase = codeEntries;
+  sideExit *hot = nullptr;
+  for(sideExit *se : sideExits) {
+    if(not(se->tried) and (se->count >= globals::reformShare * window) and
+       ((hot == nullptr) or (se->count > hot->count))) {
+      hot = se;
+    }
+  }
+  for(sideExit *se : sideExits) {
+    se->count = 0;
+  }
+  if(hot == nullptr) {
+    return;
+  }
+  hot->tried = true;
+  basicBlock *tbb = basicBlock::globalFindBlock(hot->pc);
+  if((tbb == nullptr) or (blocks.find(tbb) != blocks.end())) {
+    return;
+  }
+  std::set<basicBlock*> path;
+  augPaths(std::set<basicBlock*>{tbb}, blocks, path, 1024);
+  /* an exit that never comes back is just an exit */
+  if(path.find(tbb) == path.end()) {
+    return;
+  }
+  std::vector<basicBlock*> cur = {head}, trace = {head};
+  for(basicBlock *bb : blocks) {
+    if(bb != head) {
+      cur.push_back(bb);
+    }
+  }
+  for(basicBlock *bb : path) {
+    if(blocks.find(bb) == blocks.end()) {
+      trace.push_back(bb);
+    }
+  }
+  /* along with whatever traces the head collected meanwhile */
+  basicBlock *h = head;
+  h->addRegion(cur);
+  h->addRegion(trace);
+  std::vector<std::vector<basicBlock*>> rr;
+  rr.swap(h->bbRegions);
+  h->bbRegionCounts.clear();
+  /* so splitting a path block drops the rebuilt region too */
+  for(const auto &r : rr) {
+    for(basicBlock *rbb : r) {
+      rbb->cfgInRegions.insert(h);
+    }
+  }
+  recompile(rr, true);
+}
+
+/* the optimized copy takes over the head and the profile */
+void regionCFG::promote() {
+  regionCFG *old = replaces;
+  assert(head->cfgCplr == old);
+  old->upgrade = nullptr;
+  replaces = nullptr;
+  inscnt += old->inscnt;
+  runs += old->runs;
+  minIcnt = std::min(minIcnt, old->minIcnt);
+  maxIcnt = std::max(maxIcnt, old->maxIcnt);
+  runHistory = old->runHistory;
+  head->cfgCplr = this;
+  head->hasRegion = true;
+  if(globals::currUnit == old) {
+    globals::currUnit = this;
+  }
+  if(reformed) {
+    nReforms++;
+  }
+  else {
+    nTierUps++;
+  }
+  discard(old);
+}
+
+void regionCFG::compileWorker() {
+  while(true) {
+    regionCFG *cfg = nullptr;
+    {
+      std::unique_lock<std::mutex> lk(compileMtx);
+      compileCV.wait(lk, []{return stopCompiling or not(compileQueue.empty());});
+      if(compileQueue.empty()) {
+	return;
+      }
+      cfg = compileQueue.front();
+      compileQueue.pop_front();
+    }
+    /* a region dropped after it was queued only needs freeing */
+    if(not(cfg->cancelled)) {
+      if(cfg->analyzeGraph()) {
+	cfg->generateMachineCode(cfg->optLevel());
+      }
+      else {
+	cfg->failed = true;
+      }
+    }
+    std::unique_lock<std::mutex> lk(compileMtx);
+    compiledQueue.push_back(cfg);
+    nCompiled++;
+    compileCV.notify_all();
+  }
+}
+
+void regionCFG::startCompileThreads(size_t n) {
+  stopCompiling = false;
+  for(size_t i = 0; i < n; i++) {
+    compileThreads.emplace_back(compileWorker);
+  }
+}
+
+void regionCFG::stopCompileThreads() {
+  {
+    std::unique_lock<std::mutex> lk(compileMtx);
+    compileCV.wait(lk, []{return nInFlight == nCompiled;});
+    stopCompiling = true;
+    compileCV.notify_all();
+  }
+  for(auto &t : compileThreads) {
+    t.join();
+  }
+  compileThreads.clear();
+  installCompiled();
+}
+
+void regionCFG::installCompiled() {
+  if(nCompiled == 0) {
+    return;
+  }
+  std::deque<regionCFG*> done;
+  {
+    std::unique_lock<std::mutex> lk(compileMtx);
+    done.swap(compiledQueue);
+    nInFlight -= nCompiled;
+    nCompiled = 0;
+  }
+  for(regionCFG *cfg : done) {
+    cfg->pending = false;
+    if(cfg->cancelled) {
+      delete cfg;
+      continue;
+    }
+    if(cfg->failed) {
+      if(globals::verbose) {
+	std::cout << "COMPILE FAILED  in analysis\n";
+      }
+      /* as if buildCFG had failed, an optimized copy
+       * detaches from the region it replaces on delete */
+      if(cfg->head->cfgCplr == cfg) {
+	cfg->head->cfgCplr = nullptr;
+	cfg->head->hasRegion = false;
+      }
+      delete cfg;
+      continue;
+    }
+    cfg->installMachineCode();
+    cfg->head->hasRegion = true;
+  }
+}
+
+void regionCFG::discard(regionCFG *cfg) {
+  if(cfg->pending) {
+    /* the worker still owns it, installCompiled() frees it. its
+     * head may be freed first (dropAllBBs), and a region that was
+     * never installed has no entry point for unlinkExits to drop */
+    cfg->cancelled = true;
+    cfg->head = nullptr;
+    regionCFGs.erase(cfg);
+  }
+  else {
+    delete cfg;
+  }
 }
 
 std::ostream &operator<<(std::ostream &out, const regionCFG &cfg) {
@@ -1541,22 +2563,9 @@ void regionCFG::print() {
 
 basicBlock* regionCFG::run(state_t *ss) {
   globals::currUnit = this;
-  uint64_t nextbb = 0;
   uint64_t i0=ss->icnt;
 
-  codeBits(
-	   &(ss->pc), 
-	   ss->gpr,
-	   ss->cpr0, 
-	   ss->cpr1,
-	   ss->fcr1,
-	   ss->mem,
-	   &(ss->lo),
-	   &(ss->hi),
-	   &(ss->icnt),
-	   &(ss->abortloc),
-	   &nextbb
-	   );
+  codeBits(ss);
   globals::cBB = reinterpret_cast<basicBlock*>(ss->abortloc);
   i0 = ss->icnt - i0;
   minIcnt = std::min(minIcnt, i0);
@@ -1565,8 +2574,14 @@ basicBlock* regionCFG::run(state_t *ss) {
   runs++;
   
   inscnt+=i0;
-  icnt +=i0;
-  iters++;
+  if(isBlock) {
+    blockIcnt += i0;
+    blockIters++;
+  }
+  else {
+    icnt +=i0;
+    iters++;
+  }
 
   if(ss->icnt >= globals::dumpicnt) {
     dumpState(*ss, globals::blobName);
@@ -1574,28 +2589,79 @@ basicBlock* regionCFG::run(state_t *ss) {
     exit(-1);
   }
   
-  if(nextbb==0) {
-    //return globals::cBB->findBlock(ss->pc);
-    return globals::cBB->globalFindBlock(ss->pc);
+  /* refill the indirect branch table entry
+   * this exit may have missed on */
+  if(globals::chainRegions) {
+    auto it = entryPoints.find(ss->pc);
+    if(it != entryPoints.end()) {
+      ibtcInsert(ss->pc, it->second->codeBits);
+    }
   }
-  else {
-    basicBlock *rbb = reinterpret_cast<basicBlock*>(nextbb);
-    return rbb;
+  //return globals::cBB->findBlock(ss->pc);
+  basicBlock *nBB = globals::cBB->globalFindBlock(ss->pc);
+  /* last, an inline recompile may free this region */
+  if((++nDispatches % sweepPeriod) == 0) {
+    sweepCounters();
+  }
+  return nBB;
+}
+
+bool regionCFG::weighsExits() const {
+  return not(isBlock or isFunc) and (globals::reformShare != 0.0);
+}
+
+bool regionCFG::tierUpDue() const {
+  return quick and not(tierUpTried) and (codeEntries >= histoLen) and
+    (codeInsns >= globals::tierUpIcnt);
+}
+
+bool regionCFG::reformDue() const {
+  return not(sideExits.empty()) and ((codeEntries - reformBase) >= reformWindow);
+}
+
+/* quick regions that ran enough, however they were entered, get
+ * recompiled at --opt and the others weigh their side exits */
+void regionCFG::sweepCounters() {
+  std::vector<regionCFG*> due;
+  for(regionCFG *cfg : regionCFGs) {
+    if((cfg->upgrade == nullptr) and not(cfg->pending) and
+       (cfg->tierUpDue() or cfg->reformDue())) {
+      due.push_back(cfg);
+    }
+  }
+  /* an inline recompile frees only the region it replaces */
+  for(regionCFG *cfg : due) {
+    if(cfg->tierUpDue()) {
+      cfg->recompileOptimized();
+    }
+    else {
+      cfg->reformFromExits();
+    }
   }
 }
 
 void regionCFG::dumpIR() {
-   std::string o_name= "cfg_" + toStringHex(cfgHead->getEntryAddr()) + ".txt";
+   std::string o_name= (isBlock ? "blk_" : "cfg_") + toStringHex(cfgHead->getEntryAddr()) + ".txt";
    std::ofstream o(o_name.c_str());
    o << *this;
    o.close();
  }
  
 void regionCFG::dumpLLVM() {
-  std::string bitname= "cfg_" + toStringHex(cfgHead->getEntryAddr()) + ".bc"; 
-  int fd = open(bitname.c_str(), O_RDWR|O_CREAT, (S_IRUSR | S_IWUSR) );
+  /* the jit frees the module once it is compiled,
+   * after that only the saved bitcode is left */
+  if(myModule == nullptr and bitcode.empty()) {
+    return;
+  }
+  std::string bitname= (isBlock ? "blk_" : "cfg_") + toStringHex(cfgHead->getEntryAddr()) + ".bc"; 
+  int fd = open(bitname.c_str(), O_RDWR|O_CREAT|O_TRUNC, (S_IRUSR | S_IWUSR) );
   llvm::raw_fd_ostream bcOut(fd, false, false);
-  llvm::WriteBitcodeToFile(*myModule, bcOut);
+  if(myModule) {
+    llvm::WriteBitcodeToFile(*myModule, bcOut);
+  }
+  else {
+    bcOut << bitcode;
+  }
   bcOut.close();
   close(fd);
 }
@@ -1612,8 +2678,7 @@ void regionCFG::findLoop(std::set<cfgBasicBlock*> &loop,
     stack.pop_front();
     loop.insert(c);
     if(c != hbb) {
-      for(std::set<cfgBasicBlock*>::iterator sit = c->preds.begin(); sit != c->preds.end(); sit++) {
-	cfgBasicBlock *cc = *sit;
+      for(cfgBasicBlock *cc : c->preds) {
 	if(loop.find(cc) == loop.end()) {	
 	  stack.push_front(cc);
 	}
@@ -1741,7 +2806,7 @@ void regionCFG::findNaturalLoops() {
 void regionCFG::report(std::string &s, uint64_t icnt) {
   double frac = ((double)inscnt / (double)icnt)*100.0;
   std::stringstream ss;
-  ss << "compilation region @ 0x" << std::hex << head->getEntryAddr() << std::dec
+  ss << "compilation " << (isFunc ? "function" : "region") << " @ 0x" << std::hex << head->getEntryAddr() << std::dec
      << "(inscnt=" << inscnt
      << ",head prob=" << headProb
      << ",min icnt=" << minIcnt
@@ -1749,7 +2814,10 @@ void regionCFG::report(std::string &s, uint64_t icnt) {
      << ",avg insns=" << (static_cast<double>(inscnt) / runs)
      << ",nextpcs = " << nextPCs.size()
      << ",static icnt = " << countInsns()
+     << ",tier=" << (quick ? "quick" : "opt")
      << ",compile time = " << compileTime
+     << ",ir insns = " << irInsnsIn << "->" << irInsnsOut
+     << ",ir opt time = " << optTime
      << ",frac=" << frac << ")\n";
   s += ss.str();
 #if 1
@@ -1811,12 +2879,12 @@ uint64_t regionCFG::numBBInCommon(const regionCFG &other) const {
 }
  
 void regionCFG::toposort(std::vector<cfgBasicBlock*> &topo) const {
-  std::set<cfgBasicBlock*> visited;
+  std::vector<bool> visited(cfgBlocks.size(), false);
   std::function<void(cfgBasicBlock*)> dfs = [&](cfgBasicBlock *bb) {
     assert(bb != nullptr);
-    if(visited.find(bb) != visited.end())
+    if(visited[bb->id])
       return;
-    visited.insert(bb);
+    visited[bb->id] = true;
     for(auto nbb : bb->getSuccs()) {
       dfs(nbb);
     }
@@ -1826,6 +2894,21 @@ void regionCFG::toposort(std::vector<cfgBasicBlock*> &topo) const {
   std::reverse(topo.begin(), topo.end());
 }
 
+cfgBasicBlock *regionCFG::newBlock(basicBlock *bb, bool isLikelyPatch) {
+  cfgBasicBlock *cbb = blockArena.make<cfgBasicBlock>(bb, isLikelyPatch);
+  cbb->id = cfgBlocks.size();
+  cfgBlocks.push_back(cbb);
+  return cbb;
+}
+
+cfgBasicBlock *regionCFG::findBlock(uint32_t pc) const {
+  auto it = std::lower_bound(cfgBlockMap.begin(), cfgBlockMap.end(), pc,
+			     [](const std::pair<uint32_t, cfgBasicBlock*> &e, uint32_t pc) {
+			       return e.first < pc;
+			     });
+  return (it != cfgBlockMap.end() and it->first == pc) ? it->second : nullptr;
+}
+
 void regionCFG::splitBBs() {
   bool needSplit = false;
   
@@ -1873,8 +2956,7 @@ void regionCFG::splitBBs() {
 	  
 	  if(needSplit) {
 	    
-	    cfgBasicBlock *sbb = zbb->splitBB(splitPoint);
-	    cfgBlocks.push_back(sbb);
+	    cfgBasicBlock *sbb = zbb->splitBB(this, splitPoint);
 	    /*
 	    std::cerr << std::hex << "adding edge from "
 		      << bb->getEntryAddr()
@@ -1898,13 +2980,97 @@ void regionCFG::splitBBs() {
   while(needSplit);
 }
 
-void regionCFG::doLiveAnalysis(std::ostream &out) const {
-  
-  //for(const cfgBasicBlock *BB : cfgBlocks) {
-  //    for(const Insn *I : BB->getInsns()) {
-  //
-  //}
-  //}
-    
-  //
+void regionCFG::doLiveAnalysis() {
+  /* a register is dirty once some path from the region entry
+   * wrote it, a host call leaves everything in the state again */
+  std::vector<bool> callsOut(cfgBlocks.size());
+  for(size_t i = 0, n = cfgBlocks.size(); i < n; i++) {
+    callsOut[i] = cfgBlocks[i]->nativeCallReturn(this) != 0;
+  }
+  bool changed = true;
+  while(changed) {
+    changed = false;
+    for(cfgBasicBlock *cbb : cfgBlocks) {
+      regSet in;
+      for(cfgBasicBlock *pbb : cbb->preds) {
+	if(not(callsOut[pbb->id])) {
+	  in |= pbb->regsDirtyIn;
+	  in |= pbb->regsDefined;
+	}
+      }
+      if(not(in == cbb->regsDirtyIn)) {
+	cbb->regsDirtyIn = in;
+	changed = true;
+      }
+    }
+  }
+
+  /* backwards : a register is live into a block that reads it, or
+   * that passes it on to a read or to an exit's write back. read
+   * bits are per block, so a read after a write counts as a use.
+   * lo/hi and fpr pairs in both are partially written, a host call
+   * reloads only what it already holds, so neither kills */
+  std::vector<regSet> uses(cfgBlocks.size()), kills(cfgBlocks.size());
+  for(size_t i = 0, n = cfgBlocks.size(); i < n; i++) {
+    cfgBasicBlock *cbb = cfgBlocks[i];
+    regSet &u = uses[i], &k = kills[i];
+    u.gpr = cbb->gprRead;
+    u.fpr = cbb->fprRead;
+    u.fcr = cbb->fcrRead;
+    u.hilo = cbb->hiloRead[0] or cbb->hiloRead[1];
+    if(not(callsOut[i])) {
+      k.gpr = cbb->regsDefined.gpr;
+      k.fcr = cbb->regsDefined.fcr;
+      for(size_t r = 0; r < 32; r++) {
+	k.fpr[r] = cbb->regsDefined.fpr[r] and (allFprTouched[r] != fprUseEnum::both);
+      }
+    }
+    for(size_t r = 0; r < 32; r++) {
+      if(u.fpr[r] and allFprTouched[r] == fprUseEnum::both) {
+	u.fpr[r^1] = true;
+      }
+    }
+    cbb->regsLiveIn = regSet();
+  }
+  changed = true;
+  while(changed) {
+    changed = false;
+    for(size_t i = cfgBlocks.size(); i > 0; i--) {
+      cfgBasicBlock *cbb = cfgBlocks[i-1];
+      regSet out = exitRegs(cbb);
+      for(cfgBasicBlock *sbb : cbb->succs) {
+	out |= sbb->regsLiveIn;
+      }
+      const regSet &k = kills[i-1];
+      out.gpr &= ~k.gpr;
+      out.fpr &= ~k.fpr;
+      out.fcr &= ~k.fcr;
+      out |= uses[i-1];
+      if(not(out == cbb->regsLiveIn)) {
+	cbb->regsLiveIn = out;
+	changed = true;
+      }
+    }
+  }
+}
+
+regSet regionCFG::exitRegs(const cfgBasicBlock *cBB) const {
+  regSet dirty = cBB->regsDirtyIn;
+  dirty |= cBB->regsDefined;
+  /* both halves of an fpr pair move together */
+  for(size_t i = 0; i < 32; i++) {
+    if(dirty.fpr[i] and allFprTouched[i] == fprUseEnum::both) {
+      dirty.fpr[i^1] = true;
+    }
+  }
+  dirty.gpr[0] = false;
+  for(size_t i = 0; i < 32; i++) {
+    dirty.gpr[i] = dirty.gpr[i] and not(gprDefinitionBlocks[i].empty());
+    dirty.fpr[i] = dirty.fpr[i] and not(fprDefinitionBlocks[i].empty());
+  }
+  for(size_t i = 0; i < 5; i++) {
+    dirty.fcr[i] = dirty.fcr[i] and not(fcrDefinitionBlocks[i].empty());
+  }
+  dirty.hilo = dirty.hilo and not(hiloDefinitionBlocks.empty());
+  return dirty;
 }
@@ -8,8 +8,11 @@
 #include <vector>
 #include <list>
 #include <array>
+#include <tuple>
+#include <atomic>
 #include <cstdint>
 #include <limits.h>
+#include <boost/dynamic_bitset.hpp>
 
 #include "execUnit.hh"
 #include "basicBlock.hh"
@@ -18,6 +21,9 @@
 #include "llvmInc.hh"
 #include "perfmap.hh"
 #include "debugSymbols.hh"
+#include "transCache.hh"
+#include "smallSet.hh"
+#include "arena.hh"
 
 class regionCFG;
 class Insn;
@@ -45,21 +51,27 @@ inline std::ostream &operator<<(std::ostream &out, const fprUseEnum &fprState) {
 }
 #undef __fpr_state_list
 
-typedef void (*compiledCFG)
-(uint32_t*, /* pc */
- int32_t*, /* gpr */
- uint32_t*, /* cpr0 */
- uint32_t*, /*cpr1 */
- uint32_t*, /*fcr1 */
- uint8_t*, /* mem */
- int32_t*, /* lo */
- int32_t*, /* hi */
- uint64_t*, /* icnt */
- uint64_t*, /* abortloc */
- uint64_t*  /* nextbb */
- );
+/* guest state fields are reached at fixed offsets, guest
+ * memory at a base fixed when the region is linked */
+typedef void (*compiledCFG)(state_t*);
 
 
+/* exit from compiled code to a constant pc,
+ * target is set while pc heads compiled code */
+struct regionExit {
+  compiledCFG target = nullptr;
+  uint32_t pc = 0;
+};
+
+/* times compiled code left through one constant pc exit,
+ * counted by the exit itself */
+struct sideExit {
+  uint64_t count = 0;
+  uint32_t pc = 0;
+  /* looked at once, a region isn't rebuilt twice for it */
+  bool tried = false;
+};
+
 class phiNode : public ssaInsn {
  protected:
   llvm::PHINode *lPhi;
@@ -189,19 +201,47 @@ public:
 };
 
 
+/* guest registers written back to the state at an exit */
+struct regSet {
+  std::bitset<32> gpr, fpr;
+  std::bitset<5> fcr;
+  bool hilo = false;
+  regSet &operator|=(const regSet &o) {
+    gpr |= o.gpr; fpr |= o.fpr; fcr |= o.fcr;
+    hilo |= o.hilo;
+    return *this;
+  }
+  bool operator==(const regSet &o) const {
+    return gpr == o.gpr and fpr == o.fpr and fcr == o.fcr and hilo == o.hilo;
+  }
+  bool operator<(const regSet &o) const {
+    return std::make_tuple(gpr.to_ulong(), fpr.to_ulong(), fcr.to_ulong(), hilo) <
+      std::make_tuple(o.gpr.to_ulong(), o.fpr.to_ulong(), o.fcr.to_ulong(), o.hilo);
+  }
+};
+
 std::ostream &operator<<(std::ostream &out, const cfgBasicBlock &bb);
 
+/* blocks are numbered in creation order, so edge sets
+ * iterate the same way from run to run */
+struct orderCfgBlocks {
+  bool operator()(const cfgBasicBlock *a, const cfgBasicBlock *b) const;
+};
+
 class cfgBasicBlock {
  public:
   friend std::ostream &operator<<(std::ostream &out, const cfgBasicBlock &bb);
   friend class regionCFG;
+  typedef smallSet<cfgBasicBlock*, 2, orderCfgBlocks> blockSet;
+  /* index into the region's cfgBlocks */
+  uint32_t id = 0;
   basicBlock *bb;
   bool isLikelyPatch;
   bool hasTermBranchOrJump;
   llvmRegTables termRegTbl;
   llvm::BasicBlock *lBB;
   cfgBasicBlock *idombb;
-  std::set<cfgBasicBlock*> dtree_succs;
+  blockSet dtree_succs;
 
   std::vector<phiNode*> phiNodes;
   std::array<phiNode*,32> gprPhis;
@@ -210,12 +250,12 @@ class cfgBasicBlock {
   std::array<phiNode*,2> hiLoPhis;
   std::array<phiNode*,1> icntPhis;
 
-  std::map<llvm::BasicBlock*, llvm::BasicBlock*> jrMap;
+  smallMap<llvm::BasicBlock*, llvm::BasicBlock*, 2> jrMap;
 
   std::vector<regState> gprConstState;
-  std::set<cfgBasicBlock*> preds;
-  std::set<cfgBasicBlock*> succs;
-  std::set<cfgBasicBlock*> dfrontier;
+  blockSet preds;
+  blockSet succs;
+  blockSet dfrontier;
   std::vector<basicBlock::insPair> rawInsns;
   std::vector<Insn*> insns;
   std::vector<ssaInsn*> ssaInsns;
@@ -227,6 +267,10 @@ class cfgBasicBlock {
   std::bitset<5> fcrRead;
 
   std::vector<fprUseEnum> fprTouched;
+
+  /* written by this block's instructions, possibly different
+   * from the state and needed later, on entry to the block */
+  regSet regsDefined, regsDirtyIn, regsLiveIn;
   
   ssize_t dt_dfn = -1;
   ssize_t dt_max_ancestor_dfn = -1;
@@ -241,6 +285,7 @@ class cfgBasicBlock {
   bool checkIfPlausableSuccessors();
   void addWithInCFGEdges(regionCFG *cfg);
   bool has_jr_jalr();
+  uint32_t nativeCallReturn(const regionCFG *cfg) const;
   bool haslikely();
   bool canCompile() const;
   bool hasFloatingPoint(uint32_t *typeCnts) const;
@@ -256,7 +301,7 @@ class cfgBasicBlock {
   void patchUpPhiNodes(regionCFG *cfg);
   void bindInsns(regionCFG *cfg);
   
-  cfgBasicBlock *splitBB(uint32_t splitPC);
+  cfgBasicBlock *splitBB(regionCFG *cfg, uint32_t splitPC);
   
   bool hasBranchLikely() {
     return bb->hasBranchLikely();
@@ -265,18 +310,17 @@ class cfgBasicBlock {
   void addSuccessor(cfgBasicBlock *s);
   void delSuccessor(cfgBasicBlock *s);
   cfgBasicBlock(basicBlock *bb, bool isLikelyPatch=false);
-  ~cfgBasicBlock();
   void updateFPRTouched(uint32_t reg, fprUseEnum useType);
-  const std::set<cfgBasicBlock*> &getPreds() const {
+  const blockSet &getPreds() const {
     return preds;
   }
   size_t numSuccessors() const {
     return succs.size();
   }
-  const std::set<cfgBasicBlock*> &getSuccs() const {
+  const blockSet &getSuccs() const {
     return succs;
   }
-  const std::set<cfgBasicBlock*> &getDTSuccs() const {
+  const blockSet &getDTSuccs() const {
     return dtree_succs;
   }
   const std::vector<Insn*> &getInsns() const {
@@ -307,6 +351,42 @@ class cfgBasicBlock {
   bool dominates(const cfgBasicBlock *B) const;
 };
 
+inline bool orderCfgBlocks::operator()(const cfgBasicBlock *a, const cfgBasicBlock *b) const {
+  return a->id < b->id;
+}
+
+/* blocks of a region as bits of their ids */
+class cfgBlockSet {
+private:
+  boost::dynamic_bitset<> bits;
+public:
+  static const size_t npos = boost::dynamic_bitset<>::npos;
+  void insert(const cfgBasicBlock *b) {
+    if(b->id >= bits.size()) {
+      bits.resize(b->id + 1);
+    }
+    bits.set(b->id);
+  }
+  bool empty() const {
+    return bits.none();
+  }
+  size_t first() const {
+    return bits.find_first();
+  }
+  size_t next(size_t i) const {
+    return bits.find_next(i);
+  }
+  cfgBlockSet &operator|=(const cfgBlockSet &o) {
+    if(o.bits.size() > bits.size()) {
+      bits.resize(o.bits.size());
+    }
+    for(size_t i = o.first(); i != npos; i = o.next(i)) {
+      bits.set(i);
+    }
+    return *this;
+  }
+};
+
 class naturalLoop {
 private:
   friend class sortNaturalLoops;
@@ -365,16 +445,121 @@ protected:
   bool perfectNest = false;
   bool hasBoth = false;
   bool validDominanceAcceleration = false;
+  /* baseline tier : a single basicBlock compiled without optimization */
+  bool isBlock = false;
+  /* whole guest function, calls out of it are host calls */
+  bool isFunc = false;
+  /* first tier : codegen without optimization and a short
+   * pass pipeline, recompiled at --opt once it gets hot */
+  bool quick = false, tierUpTried = false;
+  /* bumped by the compiled code itself, so entries through a
+   * chained exit count too and a chained stretch isn't charged
+   * to the region the dispatcher happened to enter */
+  uint64_t codeEntries = 0, codeInsns = 0;
+  /* dispatcher runs between looks at every region's counters */
+  const static uint64_t sweepPeriod = 1024;
+  static uint64_t nDispatches;
+  static void sweepCounters();
+  /* optimized copy being compiled, and for that copy
+   * the region it replaces when installed */
+  regionCFG *upgrade = nullptr, *replaces = nullptr;
+  /* the copy adds the path of a hot side exit */
+  bool reformed = false;
+  /* side exits are weighed once per window of entries,
+   * the last window ended at reformBase */
+  const static uint64_t reformWindow = 1024;
+  uint64_t reformBase = 0;
+  bool weighsExits() const;
+  bool tierUpDue() const;
+  bool reformDue() const;
+  std::vector<sideExit*> sideExits;
+  /* head pc and crc of the block pcs, the translation cache key */
+  uint32_t headPC = 0, blocksCRC = 0;
+  /* queued for background code generation, only
+   * touched by the guest thread */
+  bool pending = false;
+  std::atomic<bool> cancelled;
+  /* set by the worker when analysis rejects the region */
+  bool failed = false;
   double compileTime = 0.0;
+  /* ir instructions before and after the pass pipeline */
+  uint64_t irInsnsIn = 0, irInsnsOut = 0;
+  double optTime = 0.0;
+  static void compileWorker();
+  llvm::CodeGenOpt::Level optLevel() const;
+  void recompile(std::vector<std::vector<basicBlock*>> &rr, bool reform);
+  void recompileOptimized();
+  void reformFromExits();
+  void promote();
   
  public:
   friend std::ostream &operator<<(std::ostream &out, const regionCFG &cfg);
   static uint64_t icnt;
   static uint64_t iters;
+  static uint64_t blockIcnt;
+  static uint64_t blockIters;
+  static uint64_t nBlockCompiles;
+  static uint64_t nTierUps;
+  static uint64_t nReforms;
   static std::set<regionCFG*> regionCFGs;
+  /* compiled code reachable by chained exits, keyed by entry pc */
+  static std::unordered_map<uint32_t, regionCFG*> entryPoints;
+  static std::unordered_multimap<uint32_t, regionExit*> exitsByPC;
+  static uint64_t nChainedExits;
+  /* direct mapped indirect branch translation table and
+   * every per-site inline cache of indirect exits */
+  const static size_t ibtcLen = 4096;
+  static std::array<regionExit, ibtcLen> ibtc;
+  static std::set<regionExit*> indirectSites;
+  static void ibtcInsert(uint32_t pc, compiledCFG target);
+  /* the 4GB guest mapping, it never moves once main sets it */
+  static uint8_t *guestMem;
+  /* null unless --transCache names a directory */
+  static transCache *objCache;
+  /* one jit session for every region, each in its own dylib */
+  static std::unique_ptr<llvm::orc::LLJIT> jit;
+  static void startJIT();
+  static void stopJIT();
+  /* empty when passes parses as a pass pipeline */
+  static std::string checkPasses(const std::string &passes);
+  /* the target both the ir passes and codegen tune for,
+   * the host cpu unless --jitCPU names another */
+  static llvm::orc::JITTargetMachineBuilder hostTarget();
+  /* empty when --jitCPU names a cpu llvm knows */
+  static std::string checkTarget();
+  /* shadow return stack, pushed by compiled jal/jalr
+   * and checked by compiled jr $ra */
+  struct rasEntry {
+    uint64_t link;
+    uint32_t pc;
+  };
+  const static size_t rasLen = 64;
+  static std::array<rasEntry, rasLen> ras;
+  static uint32_t rasTop;
+  /* ras link of a host call, a predicted return to it
+   * leaves the callee so the caller resumes in place */
+  static regionExit nativeReturn;
+  const static uint32_t maxCallDepth = 256;
+  static uint32_t callDepth;
   std::unordered_map<std::string, llvm::Function*> builtinFuncts;
+  /* host objects referenced by generated code, named so a cached
+   * object relocates against this run's addresses */
+  std::map<const void*, llvm::Constant*> hostGlobals;
+  std::map<std::string, uint64_t> hostSyms;
+  llvm::Value *hostAddr(const void *p, size_t offs = 0);
+  void generateCount(uint64_t *cnt, uint64_t amt);
+  /* instructions a quick region runs, counted per block */
+  void countQuickInsns(size_t n) {
+    if(quick) {
+      generateCount(&codeInsns, n);
+    }
+  }
 
-  void doLiveAnalysis(std::ostream &out) const;
+  /* per block dirty registers, so exits write back only what
+   * a path to them modified, and live registers, so only
+   * those get phis and entry loads */
+  void doLiveAnalysis();
+  regSet exitRegs(const cfgBasicBlock *cBB) const;
   
   uint64_t &getuuid() {
     return uuid;
@@ -396,17 +581,19 @@ protected:
   llvm::Function *blockFunction;
   llvm::IRBuilder<> *myIRBuilder;
   llvm::Module *myModule;
-  llvm::EngineBuilder *myEngineBuilder; 
-  llvm::ExecutionEngine *myExecEngine;
+  /* bitcode handed to the jit, kept for dumpLLVM */
+  std::string bitcode;
+  /* holds the region's code in the shared jit, removed with it */
+  llvm::orc::JITDylib *jitDylib;
   llvm::Type *type_iPtr32,*type_iPtr8;
   llvm::Type *type_iPtr64,*type_void;
   llvm::Type *type_float, *type_double;
   llvm::Type *type_int32, *type_int64;
  
-  std::set<cfgBasicBlock*> gprDefinitionBlocks[32];
-  std::set<cfgBasicBlock*> hiloDefinitionBlocks;
-  std::set<cfgBasicBlock*> fprDefinitionBlocks[32];
-  std::set<cfgBasicBlock*> fcrDefinitionBlocks[5];
+  cfgBlockSet gprDefinitionBlocks[32];
+  cfgBlockSet hiloDefinitionBlocks;
+  cfgBlockSet fprDefinitionBlocks[32];
+  cfgBlockSet fcrDefinitionBlocks[5];
 
   std::bitset<32> allGprRead;
   std::bitset<1> allHiloRead;
@@ -418,8 +605,25 @@ protected:
   std::vector< std::vector<naturalLoop> >loopNesting;
 
 
+  /* blocks, their instructions and phis live until the
+   * region is freed, all at once */
+  arena blockArena;
   std::vector<cfgBasicBlock*> cfgBlocks;
-  std::map<uint32_t, cfgBasicBlock*> cfgBlockMap;
+  /* sorted by entry pc */
+  std::vector<std::pair<uint32_t, cfgBasicBlock*>> cfgBlockMap;
+  cfgBasicBlock *findBlock(uint32_t pc) const;
+  cfgBasicBlock *newBlock(basicBlock *bb, bool isLikelyPatch = false);
+  std::vector<regionExit*> exits;
+  std::vector<regionExit*> indirectExits;
+  /* out-of-line exit shared by every constant pc exit writing
+   * back the same registers, exits branch in with their values */
+  struct exitStub {
+    llvm::BasicBlock *lBB = nullptr;
+    llvm::PHINode *vPC = nullptr, *vLoc = nullptr, *vLink = nullptr;
+    llvmRegTables regTbl;
+  };
+  std::map<std::pair<regSet,bool>, exitStub> exitStubs;
+  exitStub &getExitStub(const regSet &dirty, bool chained, llvmRegTables &regTbl);
 
   void splitBBs();
   bool allBlocksReachable(cfgBasicBlock *root);
@@ -430,6 +634,7 @@ protected:
   void insertPhis();
   void getRegDefBlocks();
   void initLLVMAndGeneratePreamble();
+  void annotateAliasing();
   llvm::BasicBlock* generateAbortBasicBlock(uint32_t abortpc,
 					    llvmRegTables& regTbl, 
 					    cfgBasicBlock *cBB,
@@ -439,13 +644,36 @@ protected:
   llvm::BasicBlock* generateAbortBasicBlock(llvm::Value *abortpc,
 					    llvmRegTables& regTbl, 
 					    cfgBasicBlock *cBB,
-					    llvm::BasicBlock *lBB);
-  regionCFG();
+					    llvm::BasicBlock *lBB,
+					    regionExit *link = nullptr,
+					    llvm::Value *vRetLink = nullptr);
+  void generateStateFlush(llvmRegTables &regTbl, const regSet &dirty);
+  void generateNativeCall(cfgBasicBlock *cBB, llvmRegTables &regTbl,
+			  uint32_t callee, uint32_t retpc);
+  void generateRASPush(uint32_t retpc, bool native = false);
+  llvm::Value *generateRASPop(llvm::Value *vNPC);
+  llvm::Value *loadExitField(regionExit *e, size_t offs, llvm::Type *ty);
+  void generateChainCall(llvm::Value *vTarget);
+  void linkExits();
+  void unlinkExits();
+  regionCFG(bool isBlock = false);
   ~regionCFG();
   bool buildCFG(std::vector<std::vector<basicBlock*> > &regions);
 
   bool analyzeGraph();
+  void optimizeModule(llvm::CodeGenOpt::Level optLevel);
   void generateMachineCode( llvm::CodeGenOpt::Level optLevel);
+  void installMachineCode();
+  bool compilePending() const {
+    return pending;
+  }
+  bool isFunction() const {
+    return isFunc;
+  }
+  static void startCompileThreads(size_t n);
+  static void stopCompileThreads();
+  static void installCompiled();
+  static void discard(regionCFG *cfg);
   void runLLVMLoopAnalysis();
   void dumpLLVM();
   void dumpIR();
@@ -468,4 +696,14 @@ protected:
   uint64_t numBBInCommon(const regionCFG &other) const;
 };
 
+/* a statically discovered guest function entered at its first
+ * instruction, jal's to other compiled code are host calls
+ * that resume at the landing pad */
+class funcCFG : public regionCFG {
+public:
+  funcCFG() : regionCFG(false) {
+    isFunc = true;
+  }
+};
+
 #endif
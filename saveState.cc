@@ -5,6 +5,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include "state.hh"
+#define ELIDE_LLVM
+#include "guestMem.hh"
 
 struct page {
   uint32_t va;
@@ -60,6 +62,7 @@ void dumpState(const state_t &s, const std::string &filename) {
     page p;
     p.va = i*4096;
     memcpy(p.data, s.mem+p.va, 4096);
+    swapGuestWords(p.data, 4096);
     wb = write(fd, &p, sizeof(p));
     assert(wb == sizeof(p));
   }
@@ -72,6 +75,9 @@ void loadState(state_t &s, const std::string &filename) {
   header h;
   size_t sz = read(fd, &h, sizeof(h));
   assert(sz == sizeof(h));
+  /* the dump stands in for the binary, profiles and
+   * cached objects are keyed by its hash */
+  uint32_t crc = update_crc(~0x0, reinterpret_cast<uint8_t*>(&h), sizeof(h));
   
   s.pc = h.pc;
   memcpy(&s.gpr,&h.gpr,sizeof(s.gpr));
@@ -86,7 +92,10 @@ void loadState(state_t &s, const std::string &filename) {
     page p;
     sz = read(fd, &p, sizeof(p));
     assert(sz == sizeof(p));
+    crc = update_crc(crc, reinterpret_cast<uint8_t*>(&p), sizeof(p));
+    swapGuestWords(p.data, 4096);
     memcpy(s.mem+p.va, p.data, 4096);
   }
   close(fd);
+  globals::elfHash = crc ^ (~0x0);
 }
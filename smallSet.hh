@@ -0,0 +1,192 @@
+#ifndef __SMALLSET_HH__
+#define __SMALLSET_HH__
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+/* sorted set with N inline elements, only spills to
+ * the heap past N (e.g jr fan-out) */
+template <typename T, size_t N, typename Compare = std::less<T>>
+class smallSet {
+private:
+  T inl[N];
+  T *data;
+  uint32_t len, cap;
+  void grow() {
+    T *nd = new T[2*cap];
+    std::copy(data, data+len, nd);
+    if(data != inl) {
+      delete [] data;
+    }
+    data = nd;
+    cap *= 2;
+  }
+public:
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  smallSet() : data(inl), len(0), cap(N) {}
+  smallSet(const smallSet &other) : smallSet() {
+    *this = other;
+  }
+  smallSet &operator=(const smallSet &other) {
+    if(this != &other) {
+      clear();
+      for(const T &v : other) {
+	insert(v);
+      }
+    }
+    return *this;
+  }
+  ~smallSet() {
+    clear();
+  }
+  iterator begin() { return data; }
+  iterator end() { return data + len; }
+  const_iterator begin() const { return data; }
+  const_iterator end() const { return data + len; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  void clear() {
+    if(data != inl) {
+      delete [] data;
+    }
+    data = inl;
+    len = 0;
+    cap = N;
+  }
+  iterator find(const T &v) {
+    iterator it = std::lower_bound(begin(), end(), v, Compare());
+    if(it != end() and not(Compare()(v, *it))) {
+      return it;
+    }
+    return end();
+  }
+  const_iterator find(const T &v) const {
+    return const_cast<smallSet*>(this)->find(v);
+  }
+  std::pair<iterator,bool> insert(const T &v) {
+    iterator it = std::lower_bound(begin(), end(), v, Compare());
+    if(it != end() and not(Compare()(v, *it))) {
+      return std::make_pair(it, false);
+    }
+    size_t pos = it - begin();
+    if(len == cap) {
+      grow();
+    }
+    std::copy_backward(data+pos, data+len, data+len+1);
+    data[pos] = v;
+    len++;
+    return std::make_pair(data+pos, true);
+  }
+  void erase(iterator it) {
+    std::copy(it+1, end(), it);
+    len--;
+  }
+};
+
+/* map with N inline entries, searched linearly while they fit.
+ * a spilled map (e.g jr fan-out) is kept sorted by key so lookups
+ * stay logarithmic */
+template <typename K, typename V, size_t N, typename Compare = std::less<K>>
+class smallMap {
+private:
+  typedef std::pair<K,V> entry;
+  entry inl[N];
+  entry *data;
+  uint32_t len, cap;
+  static bool keyLess(const entry &e, const K &k) {
+    return Compare()(e.first, k);
+  }
+  bool spilled() const {
+    return data != inl;
+  }
+  void grow() {
+    entry *nd = new entry[2*cap];
+    std::copy(data, data+len, nd);
+    if(spilled()) {
+      delete [] data;
+    }
+    else {
+      std::sort(nd, nd+len, [](const entry &a, const entry &b) {
+	  return Compare()(a.first, b.first);
+	});
+    }
+    data = nd;
+    cap *= 2;
+  }
+public:
+  typedef entry* iterator;
+  typedef const entry* const_iterator;
+  smallMap() : data(inl), len(0), cap(N) {}
+  smallMap(const smallMap &other) : smallMap() {
+    *this = other;
+  }
+  smallMap &operator=(const smallMap &other) {
+    if(this != &other) {
+      clear();
+      for(const entry &e : other) {
+	(*this)[e.first] = e.second;
+      }
+    }
+    return *this;
+  }
+  ~smallMap() {
+    clear();
+  }
+  iterator begin() { return data; }
+  iterator end() { return data + len; }
+  const_iterator begin() const { return data; }
+  const_iterator end() const { return data + len; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  void clear() {
+    if(spilled()) {
+      delete [] data;
+    }
+    data = inl;
+    len = 0;
+    cap = N;
+  }
+  iterator find(const K &k) {
+    if(spilled()) {
+      iterator it = std::lower_bound(begin(), end(), k, keyLess);
+      if(it != end() and not(Compare()(k, it->first))) {
+	return it;
+      }
+      return end();
+    }
+    for(uint32_t i = 0; i < len; i++) {
+      if(data[i].first == k) {
+	return data + i;
+      }
+    }
+    return end();
+  }
+  const_iterator find(const K &k) const {
+    return const_cast<smallMap*>(this)->find(k);
+  }
+  V &operator[](const K &k) {
+    iterator it = find(k);
+    if(it != end()) {
+      return it->second;
+    }
+    if(len == cap) {
+      grow();
+    }
+    if(not(spilled())) {
+      data[len] = std::make_pair(k, V());
+      return data[len++].second;
+    }
+    it = std::lower_bound(begin(), end(), k, keyLess);
+    size_t pos = it - begin();
+    std::copy_backward(data+pos, data+len, data+len+1);
+    data[pos] = std::make_pair(k, V());
+    len++;
+    return data[pos].second;
+  }
+};
+
+#endif
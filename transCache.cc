@@ -0,0 +1,69 @@
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+#include "transCache.hh"
+#include "helper.hh"
+
+extern const char* githash;
+
+std::atomic<uint64_t> transCache::hits(0), transCache::misses(0);
+
+transCache::transCache(const std::string &dir, uint32_t elfHash, const std::string &passes,
+		       const llvm::orc::JITTargetMachineBuilder &target) : dir(dir) {
+  mkdir(dir.c_str(), S_IRWXU);
+  /* everything besides the IR that changes the object */
+  std::stringstream ss;
+  ss << elfHash << " " << githash << " " << LLVM_VERSION_STRING << " " << passes
+     << " " << target.getCPU() << " " << target.getFeatures().getString();
+  std::string opts = ss.str();
+  optHash = crc32(reinterpret_cast<uint8_t*>(&opts[0]), opts.size());
+}
+
+void transCache::setKey(llvm::Module &M, uint32_t headPC, uint32_t regionCRC,
+			llvm::CodeGenOpt::Level optLevel, bool quick) const {
+  llvm::SmallVector<char, 0> bc;
+  llvm::raw_svector_ostream bcOut(bc);
+  llvm::WriteBitcodeToFile(M, bcOut);
+  uint32_t irHash = crc32(reinterpret_cast<uint8_t*>(bc.data()), bc.size());
+  char buf[64] = {0};
+  /* the first tier runs its own short pass pipeline */
+  snprintf(buf, sizeof(buf), "%08x_%08x_%08x_%08x_O%d%s", optHash, headPC,
+	   regionCRC, irHash, static_cast<int>(optLevel), quick ? "q" : "");
+  M.setModuleIdentifier(buf);
+}
+
+std::string transCache::fileName(const llvm::Module *M) const {
+  return dir + "/" + M->getModuleIdentifier() + ".o";
+}
+
+bool transCache::has(const llvm::Module &M) const {
+  return access(fileName(&M).c_str(), R_OK) == 0;
+}
+
+void transCache::notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef obj) {
+  /* write then rename, concurrent runs may share the directory */
+  std::string fname = fileName(M);
+  std::string tmpName = fname + "." + std::to_string(getpid());
+  std::ofstream out(tmpName, std::ios::binary);
+  if(not(out.is_open())) {
+    return;
+  }
+  out.write(obj.getBufferStart(), obj.getBufferSize());
+  out.close();
+  if(rename(tmpName.c_str(), fname.c_str()) != 0) {
+    unlink(tmpName.c_str());
+  }
+}
+
+std::unique_ptr<llvm::MemoryBuffer> transCache::getObject(const llvm::Module *M) {
+  auto buf = llvm::MemoryBuffer::getFile(fileName(M));
+  if(not(buf)) {
+    misses++;
+    return nullptr;
+  }
+  hits++;
+  return std::move(buf.get());
+}
@@ -0,0 +1,30 @@
+#ifndef __TRANS_CACHE_HH__
+#define __TRANS_CACHE_HH__
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+
+#include "llvmInc.hh"
+
+/* on-disk cache of region objects, the jit asks it before
+ * running codegen and relocates whatever it returns */
+class transCache : public llvm::ObjectCache {
+private:
+  std::string dir;
+  uint32_t optHash;
+  std::string fileName(const llvm::Module *M) const;
+public:
+  static std::atomic<uint64_t> hits, misses;
+  transCache(const std::string &dir, uint32_t elfHash, const std::string &passes,
+	     const llvm::orc::JITTargetMachineBuilder &target);
+  /* names M after the binary, region shape and its own IR */
+  void setKey(llvm::Module &M, uint32_t headPC, uint32_t regionCRC,
+	      llvm::CodeGenOpt::Level optLevel, bool quick = false) const;
+  /* true when M's object is on disk, so its ir need not be optimized */
+  bool has(const llvm::Module &M) const;
+  void notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef obj) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override;
+};
+
+#endif